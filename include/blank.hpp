@@ -0,0 +1,33 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+
+#ifndef BLANK_H
+#define BLANK_H
+
+/*** Erased data detection ****************************************************/
+//Erased NOR reads 0xFF, and programming 0xFF leaves a byte as it is, so
+//blank pages need no program and blank blocks no erase. Same split as
+//Gather: NEON on ARM, SSE2 or AVX2 on x86 (AVX2 picked at runtime), a
+//word at a time everywhere else
+namespace Blank {
+	//True if all n bytes are 0xFF. Stops at the first block that is not
+	bool isErased(const unsigned char *buf, size_t n);
+
+	//The portable version, for comparison against the vector ones
+	bool isErasedScalar(const unsigned char *buf, size_t n);
+
+	//Name of the version isErased() uses on this machine
+	const char *implName();
+} //namespace Blank
+
+#endif
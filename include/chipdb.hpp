@@ -0,0 +1,81 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+
+#ifndef CHIPDB_H
+#define CHIPDB_H
+
+/*** Built-in 25-series chip database *****************************************/
+//Compiled-in table of common parts keyed by JEDEC ID, sorted by the compiler
+//and searched with a binary search. Where several parts share an ID the
+//entry holds the most conservative of their ratings. SFDP, when the chip has
+//it, is preferred for anything both describe
+namespace ChipDb {
+	//Erase granularities, bit set per supported erase size
+	const uint8_t ERASE_4K = 0x01;    // 0x20
+	const uint8_t ERASE_32K = 0x02;   // 0x52
+	const uint8_t ERASE_64K = 0x04;   // 0xD8
+	const uint8_t ERASE_256K = 0x08;  // 0xD8 on uniform 256 KiB sector parts
+
+	//Behaviour that differs from a plain Winbond-style part
+	namespace Quirk {
+		const uint16_t QE_SR2_BIT1 = 0x0001;   // Quad Enable in SR2 bit 1
+		const uint16_t QE_SR1_BIT6 = 0x0002;   // Quad Enable in SR bit 6
+		const uint16_t QE_NONE = 0x0004;       // Quad needs no enable bit
+		const uint16_t NO_DUAL = 0x0008;       // No 0x3B/0xBB
+		const uint16_t NO_QUAD = 0x0010;       // No usable 0x6B/0xEB
+		const uint16_t ADDR4_OPCODES = 0x0020; // 4-byte opcodes over 16 MiB
+		const uint16_t ADDR4_ENTER = 0x0040;   // 0xB7/0xE9 over 16 MiB
+		const uint16_t DTR = 0x0080;           // 0x0D/0xBD/0xED reads
+		const uint16_t UNLOCK_SR = 0x0100;     // Powers up protected, write SR 0
+		const uint16_t UNLOCK_ULBPR = 0x0200;  // SST26 block protection, 0x98
+	}
+
+	//Program and erase times, typical and maximum. Chip erase scales with
+	//the size, so it is given per MiB
+	struct Timing {
+		uint32_t ppTypUs, ppMaxUs;              // Page (or byte) program
+		uint32_t seTypMs, seMaxMs;              // 4 KiB sector erase
+		uint32_t beTypMs, beMaxMs;              // 64 KiB block erase
+		uint32_t ceTypMsPerMiB, ceMaxMsPerMiB;  // Chip erase
+	};
+
+	//Used when a part is not in the table
+	extern const Timing GENERIC_TIMING;
+
+	struct Chip {
+		uint32_t id;            // manufacturer << 16 | memory type << 8 | capacity
+		const char *name;
+		uint32_t bytes;
+		uint16_t pageSize;      // 1 for byte program only parts
+		uint8_t erase;          // ERASE_* mask
+		uint16_t readMHz;       // Read (0x03)
+		uint16_t fastMHz;       // Fast, dual, quad and DTR reads, the lowest
+		                        // of their ratings
+		const Timing *timing;
+		uint16_t quirks;
+
+		bool has(uint16_t quirk) const { return (quirks & quirk) != 0; }
+		//Program/erase times of the part
+		const Timing &times() const { return *timing; }
+	};
+
+	//Entry for a JEDEC ID, nullptr if the part is not known
+	const Chip *find(unsigned char manufacturer, unsigned char memoryType,
+	                 unsigned char capacity);
+
+	//Number of parts in the table
+	size_t count();
+} //namespace ChipDb
+
+#endif
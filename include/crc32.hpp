@@ -0,0 +1,30 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+
+#ifndef CRC32_H
+#define CRC32_H
+
+/*** CRC-32 (IEEE 802.3, same as zlib and cksum -a crc32b) ********************/
+//Running checksum, feed update() any number of times then read value()
+class Crc32 {
+	public:
+	void update(const unsigned char *data, size_t n);
+	uint32_t value() const { return ~crc; }
+	void reset() { crc = 0xFFFFFFFFu; }
+
+	private:
+	uint32_t crc = 0xFFFFFFFFu;
+}; //class Crc32
+
+#endif
@@ -0,0 +1,60 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "chipdb.hpp"
+
+#ifndef ERASEPLAN_H
+#define ERASEPLAN_H
+
+/*** Erase planning ***********************************************************/
+//Which erase commands cover a range in the least time. Each erase clears a
+//block aligned to its own size, so a range is widened to the smallest
+//block, then covered with the mix of block sizes whose typical times add up
+//to the least. In practice that is the largest blocks that fit, with the
+//small ones only at unaligned edges
+namespace ErasePlan {
+	//An erase command the chip has, with its typical time
+	struct Type {
+		uint32_t bytes;
+		unsigned char cmd;      // 3-byte address opcode
+		uint32_t typMs;
+	};
+
+	struct Step {
+		uint64_t addr;
+		uint32_t bytes;
+		unsigned char cmd;
+	};
+
+	struct Plan {
+		uint64_t start = 0;     // What the steps erase, [start, end)
+		uint64_t end = 0;
+		std::vector<Step> steps;
+		uint64_t typMs = 0;     // Sum of the typical times
+
+		//False when the steps erase more than was asked for
+		bool exact(uint64_t from, uint64_t to) const { return start == from && end == to; }
+	};
+
+	//Cover [from, to) widened to the smallest type's alignment, no step
+	//reaches past that. No steps when types is empty or the range is
+	Plan plan(const std::vector<Type> &types, uint64_t from, uint64_t to);
+
+	//Typical time of a bytes sized erase from a family's timings. 32 KiB is
+	//taken as half way between 4 and 64 KiB, larger blocks as 64 KiB ones
+	uint32_t typicalMs(const ChipDb::Timing &timing, uint32_t bytes);
+} //namespace ErasePlan
+
+#endif
@@ -11,17 +11,24 @@
 *******************************************************************************/
 #include <iostream>
 #include <fstream>
+#include <cstddef>
+#include <cstdint>
 
 #ifndef FILEMAN_H
 #define FILEMAN_H
 
+//Default size of the RAM byte array
+#define MAX_RAM_BYTES 10485760
+
 //Object containing the filename, data pointers, functions etc for binary files
 class BinFile {
 	public:
 	//Constructor sets the filename string, creates the byteArray heap alloc
 	//and opens the input file as input or output
 	//mode:   'r' read file          'w' write file
-	BinFile(const char *inptFN, const char mode);
+	//arrayBytes sets the RAM array size, smaller when many files are open
+	BinFile(const char *inptFN, const char mode,
+	        const size_t arrayBytes = MAX_RAM_BYTES);
 	
 	//Destructor flushes the byteArray to the file, deletes the byteArray and
 	//closes the file
@@ -32,11 +39,23 @@ class BinFile {
 	
 	/*** File Reading (for dump: push bytes to file) **************************/
 	void pushByteToArray(const char byte);
+	//Push count bytes at once, flushing to the file whenever the array fills
+	void pushBytesToArray(const char *bytes, const size_t count);
 	int flushArrayToFile();
+	//Touch every page of the array so no page fault lands mid-transfer
+	void prefault();
+	//Flush, then carry on pushing at byte pos of the file. Skipped parts
+	//are left as holes
+	void seekWrite(const uint64_t pos);
 	
 	/*** File Reading (for flash: pull bytes from file) ***********************/
 	// Returns true and sets byte if a byte was read; false on EOF.
 	bool pullByteFromFile(char &byte);
+	// Pull up to count bytes into bytes. Returns how many were read (less
+	// than count only at EOF)
+	size_t pullBytesFromFile(char *bytes, const size_t count);
+	// Drop what is buffered and carry on pulling from byte pos of the file
+	void seekRead(const uint64_t pos);
 	
 	// Whether the file was opened for reading (mode 'r')
 	bool isReadMode() const { return readMode; }
@@ -44,8 +63,8 @@ class BinFile {
 	private:
 	std::fstream file;
 	char *filename;
-	#define MAX_RAM_BYTES 10485760
 	char *byteArrayPtr;
+	unsigned int byteArraySize;
 	unsigned int byteArrayPos = 0;
 	bool readMode = false;
 	// For read mode: bytes currently in buffer (0 when buffer exhausted)
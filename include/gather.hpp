@@ -0,0 +1,43 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+
+#ifndef GATHER_H
+#define GATHER_H
+
+/*** Bulk decoding of captured GPIO levels ************************************/
+//The receive kernels store one raw GPLEV snapshot per clock and leave the bit
+//work until the block is done. These turn the snapshots back into bytes.
+//NEON is used on ARM when the compiler targets it, SSE2 or AVX2 on x86
+//(AVX2 picked at runtime), with a plain loop everywhere else.
+namespace Gather {
+	//Pack bit `pin` of every snapshot into bytes, MSBFirst, 8 snapshots per
+	//byte. count is in snapshots, a trailing partial byte is ignored
+	void packBits(const uint32_t *levels, size_t count, unsigned int pin,
+	              unsigned char *out);
+
+	//Split the snapshots into one byte stream per pin, out[i] receiving pin
+	//pins[i]. Each pin is a packBits() pass over a block that sits in cache
+	void packBitsMulti(const uint32_t *levels, size_t count,
+	                   const unsigned int *pins, size_t pinCount,
+	                   unsigned char *const *out);
+
+	//The portable version, for comparison against the vector ones
+	void packBitsScalar(const uint32_t *levels, size_t count, unsigned int pin,
+	                    unsigned char *out);
+
+	//Name of the version packBits() uses on this machine
+	const char *implName();
+} //namespace Gather
+
+#endif
@@ -0,0 +1,78 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+
+#ifndef GPIOMEM_H
+#define GPIOMEM_H
+
+/*** BCM283x/BCM2711 GPIO register block (32-bit word offsets) ****************/
+namespace GpioReg {
+	const unsigned int GPFSEL0 = 0x00 / 4;  // Function select, 10 pins per word
+	const unsigned int GPSET0  = 0x1C / 4;  // Output set, write 1 to set
+	const unsigned int GPCLR0  = 0x28 / 4;  // Output clear, write 1 to clear
+	const unsigned int GPLEV0  = 0x34 / 4;  // Pin level, read only
+
+	const std::size_t BLOCK_SIZE = 4096;    // Size mapped from /dev/gpiomem
+
+	const unsigned int FSEL_INPUT  = 0;
+	const unsigned int FSEL_OUTPUT = 1;
+}
+
+/*** Direct GPIO register access **********************************************/
+//Maps the GPIO register block through /dev/gpiomem so the bit-bang loops can
+//drive GPSET/GPCLR and sample GPLEV with plain volatile stores and loads,
+//instead of a pigpio library call per edge. Only bank 0 (GPIO 0-31) is used.
+class GpioMem {
+	public:
+	GpioMem() = default;
+	//Unmaps the register block if it was mapped by open()
+	~GpioMem();
+
+	GpioMem(const GpioMem &) = delete;
+	GpioMem &operator=(const GpioMem &) = delete;
+
+	//Map the register block from a device file. Returns false on failure
+	bool open(const char *path = "/dev/gpiomem");
+
+	//Use an existing mapping as the register block, e.g. an anonymous mmap of
+	//GpioReg::BLOCK_SIZE bytes standing in for the hardware when testing.
+	//The caller keeps ownership of the memory.
+	void attach(volatile uint32_t *base);
+
+	//Unmap (or detach) the register block
+	void close();
+
+	bool isOpen() const { return regs != nullptr; }
+
+	/*** Register access, inline for the bit-bang inner loops *****************/
+	void set(const uint32_t mask) { regs[GpioReg::GPSET0] = mask; }
+	void clr(const uint32_t mask) { regs[GpioReg::GPCLR0] = mask; }
+	uint32_t lev() const { return regs[GpioReg::GPLEV0]; }
+
+	void write(const unsigned int pin, const unsigned int level) {
+		if(level) { set(1u << pin); } else { clr(1u << pin); }
+	}
+	unsigned int read(const unsigned int pin) const {
+		return (lev() >> pin) & 0x01;
+	}
+
+	//Set a pin to input or output (GpioReg::FSEL_INPUT / FSEL_OUTPUT)
+	void setMode(const unsigned int pin, const unsigned int mode);
+
+	private:
+	volatile uint32_t *regs = nullptr;
+	//True if regs was mapped by open() and must be unmapped
+	bool owned = false;
+}; //class GpioMem
+
+#endif
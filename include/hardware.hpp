@@ -11,15 +11,54 @@
 *******************************************************************************/
 
 #include "filemanager.hpp"
+#include "gpiomem.hpp"
+#include "wave.hpp"
+#include "timing.hpp"
+#include "masktable.hpp"
+#include "kernels.hpp"
+#include "sfdp.hpp"
+#include "chipdb.hpp"
+#include "ranges.hpp"
+#include "patch.hpp"
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
 
 #ifndef HARDWARE_H
 #define HARDWARE_H
 
 /*** Common limits ************************************************************/
 namespace Limits {
-	const unsigned long MAX_BYTES = 268435456u;  // 256 MiB
-	const int MAX_KHZ = 1000;
+	const uint64_t MAX_BYTES = 268435456u;       // 256 MiB
+	const uint64_t S25_BANK_BYTES = 16777216u;   // Reach of a 3-byte address
+	const int MAX_KHZ = 10000;                   // 50ns half period
 	const unsigned int S25_PAGE_SIZE = 256;
+	const unsigned int S25_SECTOR_SIZE = 4096;
+	const unsigned int S25_READ_MAX_KHZ = 33000; // Read (0x03) rating, most parts
+	const unsigned int S25_FAST_DUMMY = 8;       // Fast Read dummy clocks
+	const unsigned int S25_QUAD_IO_DUMMY = 4;    // Quad I/O Read, after mode
+	const unsigned int S25_DTR_FAST_DUMMY = 6;   // DTR reads, Winbond defaults
+	const unsigned int S25_DTR_DUAL_DUMMY = 4;
+	const unsigned int S25_DTR_QUAD_DUMMY = 7;
+	const unsigned char S25_XIP_MODE = 0xA5;     // Continuous read mode byte:
+	                                             // M5-4 = 10 Winbond/GigaDevice,
+	                                             // P7-4 != P3-0 Macronix
+	const unsigned int XFER_CHUNK = 4096;        // Bytes per bulk read call
+	const unsigned int CAPTURE_BYTES = 512;      // Bytes per level capture block
+	const int SPIDEV_MAX_KHZ = 50000;            // spidev speed used for "max"
+	const unsigned int PROBE_KHZ = 100;          // Auto speed: clock for the ID
+	const unsigned int AUTO_UNKNOWN_KHZ = 1000;  // Auto speed, part not known
+	const uint64_t BUSY_MIN_US = 100000;         // Shortest program/erase timeout
+	const uint64_t RANGE_GAP = 4096;             // --ranges: gap read through
+	const uint64_t DIFF_RUN_BYTES = 1048576;     // --diff: most changed bytes
+	                                             // held before erasing them
+	const unsigned int S25_UNIQUE_ID_BYTES = 8;  // Read Unique ID (0x4B)
+	const unsigned int WAVE_SAMPLE_US = 1;       // pigpio sample rate for waves
+	const unsigned int WAVE_MIN_HALF_US = 2;     // 2 samples per half period
 }
 
 /*** Default SPI pinout (matches README) ***************************************/
@@ -36,6 +75,9 @@ namespace Pinout {
 namespace Cmd {
 	namespace S25 {
 		const unsigned char READ = 0x03;
+		const unsigned char FAST_READ = 0x0B;
+		const unsigned char DUAL_READ = 0x3B;     // Dual output
+		const unsigned char DUAL_IO_READ = 0xBB;  // Dual address and data
 		const unsigned char WRITE_ENABLE = 0x06;
 		const unsigned char PAGE_PROGRAM = 0x02;
 		const unsigned char SECTOR_ERASE_4K = 0x20;
@@ -44,6 +86,39 @@ namespace Cmd {
 		const unsigned char CHIP_ERASE = 0xC7;
 		const unsigned char READ_JEDEC_ID = 0x9F;
 		const unsigned char READ_STATUS = 0x05;
+		const unsigned char READ_STATUS2 = 0x35;
+		const unsigned char WRITE_STATUS = 0x01;
+		const unsigned char WRITE_STATUS2 = 0x31;
+		const unsigned char QUAD_READ = 0x6B;     // Quad output
+		const unsigned char QUAD_IO_READ = 0xEB;  // Quad address and data
+		const unsigned char DTR_FAST_READ = 0x0D;    // Address and data on both edges
+		const unsigned char DTR_DUAL_IO_READ = 0xBD;
+		const unsigned char DTR_QUAD_IO_READ = 0xED;
+		const unsigned char GLOBAL_UNLOCK = 0x98; // SST26 block protection (ULBPR)
+		const unsigned char READ_UNIQUE_ID = 0x4B;
+		const unsigned char ENTER_QPI = 0x38;     // Winbond, GigaDevice
+		const unsigned char EXIT_QPI = 0xFF;
+		const unsigned char ENTER_QPI_MX = 0x35;  // Macronix (EQIO)
+		const unsigned char EXIT_QPI_MX = 0xF5;   // Macronix (RSTQIO)
+		
+		//4-byte addressing, for parts over 16 MiB
+		const unsigned char ENTER_4B = 0xB7;
+		const unsigned char EXIT_4B = 0xE9;
+		const unsigned char WRITE_EAR = 0xC5;     // Extended (bank) address register
+		const unsigned char READ_EAR = 0xC8;
+		const unsigned char READ_4B = 0x13;
+		const unsigned char FAST_READ_4B = 0x0C;
+		const unsigned char DUAL_READ_4B = 0x3C;
+		const unsigned char DUAL_IO_READ_4B = 0xBC;
+		const unsigned char QUAD_READ_4B = 0x6C;
+		const unsigned char QUAD_IO_READ_4B = 0xEC;
+		const unsigned char DTR_FAST_READ_4B = 0x0E;
+		const unsigned char DTR_DUAL_IO_READ_4B = 0xBE;
+		const unsigned char DTR_QUAD_IO_READ_4B = 0xEE;
+		const unsigned char PAGE_PROGRAM_4B = 0x12;
+		const unsigned char SECTOR_ERASE_4K_4B = 0x21;
+		const unsigned char BLOCK_ERASE_32K_4B = 0x5C;
+		const unsigned char BLOCK_ERASE_64K_4B = 0xDC;
 	}
 }
 
@@ -54,9 +129,22 @@ struct ChipId {
 	unsigned char capacity;
 };
 
+/*** Read command, and the dummy clocks between its address and the data *****/
+//The command byte always goes out on one lane. The address and mode byte use
+//addrLanes, the data dataLanes. mode is -1 when the command has no mode byte
+struct ReadOp {
+	unsigned char cmd = 0x03;
+	unsigned int addrLanes = 1;
+	unsigned int dataLanes = 1;
+	int mode = -1;
+	unsigned int dummyCycles = 0;
+	bool dtr = false;  // Address, mode and data on both clock edges
+	unsigned int addrBytes = 3;
+};
+
 //List of supported interfaces, selected via cli.
 enum class IFACE { 
-	SPI, DSPI, QSPI, I2C
+	SPI, DSPI, QSPI, I2C, SPIDEV, WAVE
 };
 
 //List of supported protocols, e.g. 24 Series (I2C), 25 Series (SPI), etc
@@ -64,6 +152,20 @@ enum class PROT {
 	S24, S25
 };
 
+//GPIO driver used by the bit-banged interfaces. pigpio library calls, or
+//direct register access through /dev/gpiomem
+enum class GPIODRV {
+	PIGPIO, GPIOMEM
+};
+
+//How addresses above 16 MiB are sent. AUTO picks OPCODES when the access
+//needs it, THREE refuses it. OPCODES uses the dedicated 4-byte commands,
+//ENTER switches the chip to 4-byte mode (0xB7/0xE9), BANK sets the upper
+//address byte in the extended address register
+enum class ADDRMODE {
+	AUTO, THREE, OPCODES, ENTER, BANK
+};
+
 
 /*** Device Specific Struct ***************************************************/
 //Each device has a struct with data about itself, eg the size (bytes),
@@ -71,13 +173,33 @@ enum class PROT {
 struct Device {
 	IFACE interface;
 	PROT protocol;
-	int KHz;
-	unsigned long bytes;
-	unsigned long offset;
+	GPIODRV gpioDriver;
+	int KHz;              // 0 for max, -1 picks it from the chip database
+	uint64_t bytes;       // 0 fills it from the chip size by initRead
+	uint64_t offset;
+	std::string spidevPath;  // Device node used by IFACE::SPIDEV
 	ChipId jedecId;       // Filled by initRead / readId when available
 	bool jedecValid;      // True if jedecId has been read
-	Device() : interface(IFACE::SPI), protocol(PROT::S25), KHz(100), bytes(0),
-	           offset(0), jedecValid(false) {}
+	std::vector<int> misoPins;  // Multi-chip dump: one MISO GPIO per chip
+	bool realtime;        // Run the transfer SCHED_FIFO with memory locked
+	int realtimeCpu;      // Core the transfer is pinned to, -1 for any
+	unsigned char readCmd;  // Dump read command, 0 picks one from the clock
+	int dummyCycles;      // Dummy clocks after the address, -1 for the default
+	bool qpi;             // Write and erase in QPI (4-4-4) mode, QSPI only
+	bool blankCheck;      // Range erase reads each block, skips erased ones
+	bool diff;            // Write only the erase units that differ
+	std::string manifest;      // Earlier write's manifest, only changes written
+	std::string saveManifest;  // Where to save this write's manifest
+	unsigned int sampleUnits;  // Unchanged units read back to check a manifest
+	ADDRMODE addrMode;    // 3 or 4-byte addressing
+	FlashCaps caps;       // Filled from SFDP by initRead / initWrite
+	const ChipDb::Chip *chip;  // Database entry for jedecId, nullptr if unknown
+	Device() : interface(IFACE::SPI), protocol(PROT::S25),
+	           gpioDriver(GPIODRV::PIGPIO), KHz(100), bytes(0), offset(0),
+	           spidevPath("/dev/spidev0.0"), jedecValid(false),
+	           realtime(false), realtimeCpu(-1), readCmd(0), dummyCycles(-1),
+	           qpi(false), blankCheck(false), diff(false),
+	           sampleUnits(0), addrMode(ADDRMODE::AUTO), chip(nullptr) {}
 }; //struct Device
 
 /*** Base interface for flash hardware (for expansion) *************************/
@@ -89,6 +211,78 @@ public:
 	virtual char readByte() = 0;
 	virtual void writeByte(char byte) = 0;
 	virtual bool readId(ChipId &id) = 0;
+	
+	// Bulk transfers of n bytes between start() and stop(). transfer() is full
+	// duplex; tx may be nullptr (output not driven) and rx may be nullptr
+	// (input discarded). The defaults fall back to readByte()/writeByte(),
+	// interfaces should override them with a native loop.
+	virtual void transfer(const unsigned char *tx, unsigned char *rx, size_t n);
+	virtual void read(unsigned char *buf, size_t n) { transfer(nullptr, buf, n); }
+	virtual void write(const unsigned char *buf, size_t n) { transfer(buf, nullptr, n); }
+	
+	// Largest read worth passing to read() in one call
+	virtual size_t preferredChunk() const { return Limits::XFER_CHUNK; }
+	
+	// Clock the interface runs at in KHz, the measured one for bit-banging.
+	// 0 if unknown
+	virtual unsigned int clockKHz() const { return 0; }
+	
+	// Clock cycles with the data lines undriven, e.g. Fast Read dummy cycles.
+	// The default clocks whole bytes, returns false if cycles is not a multiple
+	// of 8 and the interface cannot do single clocks
+	virtual bool dummy(unsigned int cycles);
+	
+	// Data lines per clock the interface can drive (1 SPI, 2 dual, 4 quad),
+	// and transfers over that many. Only called with lanes <= maxLanes(), the
+	// defaults are the single lane write() and read()
+	virtual unsigned int maxLanes() const { return 1; }
+	virtual void writeWide(const unsigned char *buf, size_t n, unsigned int lanes) {
+		(void)lanes;
+		write(buf, n);
+	}
+	virtual void readWide(unsigned char *buf, size_t n, unsigned int lanes) {
+		(void)lanes;
+		read(buf, n);
+	}
+	
+	// Double transfer rate phases, lanes bits on both clock edges. Only
+	// called when dtrCapable(), the defaults do nothing
+	virtual bool dtrCapable() const { return false; }
+	virtual void writeDtr(const unsigned char *buf, size_t n, unsigned int lanes) {
+		(void)buf; (void)n; (void)lanes;
+	}
+	virtual void readDtr(unsigned char *buf, size_t n, unsigned int lanes) {
+		(void)buf; (void)n; (void)lanes;
+	}
+	
+	// Random access read of n bytes at addr with op, as its own CS cycle.
+	// When op has a mode byte (Dual/Quad I/O Read, 0xBB/0xEB and the DTR
+	// versions) it is sent as Limits::S25_XIP_MODE, which leaves the chip in
+	// continuous read: the reads after the first skip the opcode and send
+	// only the address, mode byte and dummy clocks. endRandomRead() takes the
+	// chip out again and must come before any other command. Returns false
+	// if the interface cannot do op or the transfer failed
+	bool readAt(const ReadOp &op, uint64_t addr, unsigned char *buf, size_t n);
+	void endRandomRead();
+	
+	// Send op's command, address, mode byte and dummy cycles. CS must already
+	// be asserted, the data follows on op.dataLanes. sendCmd false leaves the
+	// opcode out, for a chip in continuous read. Returns false if the
+	// interface cannot do op
+	bool beginRead(const ReadOp &op, uint64_t addr, bool sendCmd = true);
+	
+	// True once a transfer has failed, e.g. the wave decoder missed MISO
+	// samples. It stays set: what was read is not the chip's data, so the
+	// operation using the interface must stop rather than carry on with it
+	bool failed() const { return transferFailed; }
+	
+	protected:
+	void setFailed() { transferFailed = true; }
+	
+	private:
+	bool transferFailed = false;
+	bool continuous = false;
+	ReadOp continuousOp;
 };
 
 /*** Hardware I2C Interface ***************************************************/
@@ -104,14 +298,19 @@ public:
 /*** Hardware SPI Interface ***************************************************/
 class hwSPI : public FlashInterface {
 	public:
-	//Constructor. Pass the pin numbers to the onject class
-	hwSPI(int SCLK, int MOSI, int MISO, int CS, int WP);
+	//Constructor. Pass the pin numbers to the onject class. If mem is given
+	//the pins are driven through its registers, otherwise through pigpio
+	hwSPI(int SCLK, int MOSI, int MISO, int CS, int WP, GpioMem *mem = nullptr);
 	
 	//Initialise the interface to basic non-selected idle state
 	void init();
 	
-	//Set the internal delay times for key aspects of the interface
-	void setTiming(unsigned int KHz);
+	//Set the internal delay times for key aspects of the interface. The
+	//clock is measured and the waits trimmed for the time the edges take
+	virtual void setTiming(unsigned int KHz);
+	//Clock rate measured by the last setTiming(), in KHz
+	unsigned int achievedKHz() const { return achieved; }
+	unsigned int clockKHz() const override { return achieved; }
 	
 	//Write Protect: enable=true drives WP high (protected), false = not protected
 	void setWriteProtect(bool enable);
@@ -120,6 +319,8 @@ class hwSPI : public FlashInterface {
 	void tx_byte(const char byte);
 	//Receive a byte using the SPI interface
 	char rx_byte(void);
+	//Transmit and receive a byte at the same time
+	char xfer_byte(const char byte);
 	
 	// FlashInterface: start/stop SPI; readByte/rx_byte and writeByte/tx_byte
 	void start() override;
@@ -128,52 +329,249 @@ class hwSPI : public FlashInterface {
 	void writeByte(char byte) override;
 	bool readId(ChipId &id) override;
 	bool readJedecId(ChipId &id);
+	void transfer(const unsigned char *tx, unsigned char *rx, size_t n) override;
+	//Any number of cycles, the bits after the last whole byte are single clocks
+	bool dummy(unsigned int cycles) override;
 	
-	private:
+	//Multi-lane and DTR phases. Lanes above maxLanes() are for the dual and
+	//quad interfaces, which set the pin directions in prepareLanes()
+	void writeWide(const unsigned char *buf, size_t n, unsigned int lanes) override;
+	void readWide(unsigned char *buf, size_t n, unsigned int lanes) override;
+	bool dtrCapable() const override { return true; }
+	void writeDtr(const unsigned char *buf, size_t n, unsigned int lanes) override;
+	void readDtr(unsigned char *buf, size_t n, unsigned int lanes) override;
+	
+	//Multi-chip receive. The chips share SCLK, MOSI and CS, and each has its
+	//own MISO GPIO in bank 0. setMisoPins() makes them inputs, readMulti()
+	//then clocks n bytes once and writes chip i's data to outs[i]
+	void setMisoPins(const std::vector<int> &pins);
+	void readMulti(unsigned char *const *outs, size_t n);
+	
+	protected:
 	//hardware pins (Clock, M-Out, M-In, Chip Select, Write Protect)
 	int io_SCLK, io_MOSI, io_MISO, io_CS, io_WP;
+	//Level last set by setWriteProtect()
+	bool wpLevel = true;
 	
 	//Key timing delay values. Default 0, full speed
-	unsigned int wait_clk = 0, wait_byte = 0, wait_bit = 0;
-
+	//wait_bit: low half of the clock (data set up), wait_clk: high half,
+	//wait_cs: CS setup and hold
+	Timing::Wait wait_clk, wait_cs, wait_bit;
+	unsigned int achieved = 0;
+	
+	//Time the clock over 512 cycles with CS high, average half period in ns
+	double measureHalfNs();
+	
+	//Bit-bang n bytes with the kernel matching the driver and timing. tx or
+	//rx may be nullptr, as for transfer()
+	void bitbang(const unsigned char *tx, unsigned char *rx, size_t n);
+	//The same over 2 or 4 lanes, the pin directions must already be set
+	void bitbangLanes(const Kernel::Lanes &lanes, unsigned int count,
+	                  const unsigned char *tx, unsigned char *rx, size_t n);
+	//DTR transfer over 1, 2 or 4 lanes, the pin directions must already be set
+	void bitbangDtr(const Kernel::Lanes &lanes, unsigned int count,
+	                const unsigned char *tx, unsigned char *rx, size_t n);
+	
+	//Point the data pins for a phase of this many lanes, driven (output) or
+	//released, and return the kernel lanes for it
+	virtual const Kernel::Lanes &prepareLanes(unsigned int lanes, bool output);
+	Kernel::Lanes singleLanes;
+	//Clock SCLK n times with the data lines left as they are
+	void clockBits(unsigned int n);
+	
+	//Direct register driver, nullptr when using pigpio
+	GpioMem *gpio;
+	//Bank 0 bit masks of the data and clock pins, for the register driver
+	uint32_t mask_SCLK, mask_MOSI, mask_MISO;
+	
+	//Byte to GPSET/GPCLR store table for transmitting, the compile-time
+	//default pinout table unless the pins differ
+	const MaskTable::Table *txTable;
+	std::unique_ptr<MaskTable::Table> ownTable;
+	
+	//GPLEV snapshots for one receive block, CAPTURE_BYTES * 8 of them
+	std::vector<uint32_t> levelBuf;
+	//MISO GPIOs for readMulti()
+	std::vector<unsigned int> multiMiso;
+	
+	//Single pin access through whichever driver is selected
+	void pinMode(int pin, bool output);
+	void pinWrite(int pin, unsigned int level);
 
 }; //class hwSPI
 
-/*** Hardware Dual SPI Interface (stub; same commands, dual data lines) *******/
-class hwDSPI : public FlashInterface {
-public:
-	void start() override {}
-	void stop() override {}
-	char readByte() override { return 0; }
-	void writeByte(char) override {}
-	bool readId(ChipId &id) override { (void)id; return false; }
-};
+/*** DMA Timed Waveform SPI Interface *****************************************/
+//Same pins as hwSPI, but every transfer is compiled into pigpio DMA waveforms
+//so SCLK/MOSI edges are hardware timed, and MISO is recovered from pigpio's
+//DMA level samples. Needs the pigpio sample rate set to
+//Limits::WAVE_SAMPLE_US (gpioCfgClock) before gpioInitialise().
+class hwWaveSPI : public hwSPI {
+	public:
+	hwWaveSPI(int SCLK, int MOSI, int MISO, int CS, int WP);
+	~hwWaveSPI();
+	
+	//Half period is 500/KHz us, no lower than Limits::WAVE_MIN_HALF_US
+	void setTiming(unsigned int KHz) override;
+	
+	void transfer(const unsigned char *tx, unsigned char *rx, size_t n) override;
+	char readByte() override;
+	void writeByte(char byte) override;
+	//The sampled decoder only sees MISO at the falling edge
+	bool dtrCapable() const override { return false; }
+	
+	//Called from pigpio's sample thread with each batch of level samples
+	void feedSamples(const Wave::Sample *samples, size_t count);
+	
+	private:
+	unsigned int halfUs = Limits::WAVE_MIN_HALF_US;
+	
+	//Decoder fed from pigpio's sample thread, guarded by sampleMutex
+	Wave::MisoDecoder decoder;
+	bool decoding = false;
+	uint32_t armTick = 0;
+	std::mutex sampleMutex;
+	std::condition_variable sampleDone;
+	
+	//Build, transmit and wait for one batch of waves
+	bool sendBatch(const unsigned char *tx, unsigned char *rx, size_t n);
+}; //class hwWaveSPI
 
-/*** Hardware Quad SPI Interface (stub; same commands, quad data lines) ******/
-class hwQSPI : public FlashInterface {
-public:
-	void start() override {}
-	void stop() override {}
-	char readByte() override { return 0; }
-	void writeByte(char) override {}
-	bool readId(ChipId &id) override { (void)id; return false; }
-};
+/*** Linux spidev Hardware SPI Interface **************************************/
+//ioctl() signature, replaceable so the interface can run against a stand-in
+typedef int (*SpidevIoctl)(int fd, unsigned long request, void *arg);
+
+class hwSpidev : public FlashInterface {
+	public:
+	//Open a spidev node (e.g. /dev/spidev0.0) at speedHz, SPI mode 0. The
+	//controller's CE line is held between start() and stop() using
+	//cs_change. ioctlFn replaces ::ioctl for every request, nullptr uses
+	//::ioctl
+	hwSpidev(const std::string &path, unsigned int speedHz,
+	         SpidevIoctl ioctlFn = nullptr);
+	~hwSpidev();
+	
+	//True if the device opened and accepted the mode and speed
+	bool isOpen() const { return fd >= 0; }
+	//Change the clock, returns false if the driver refused it
+	bool setSpeed(unsigned int speedHz);
+	unsigned int speedHz() const { return speed; }
+	unsigned int clockKHz() const override { return speed / 1000; }
+	
+	void start() override;
+	void stop() override;
+	char readByte() override;
+	void writeByte(char byte) override;
+	bool readId(ChipId &id) override;
+	void transfer(const unsigned char *tx, unsigned char *rx, size_t n) override;
+	size_t preferredChunk() const override { return bufsiz; }
+	
+	private:
+	int fd = -1;
+	unsigned int speed;
+	SpidevIoctl ioctlFn;
+	//Largest single message the spidev driver accepts (module param bufsiz)
+	size_t bufsiz = 4096;
+	
+	//Send one SPI_IOC_MESSAGE of up to bufsiz bytes. keepCs leaves the
+	//controller's CE asserted once the message is done
+	bool message(const unsigned char *tx, unsigned char *rx, size_t n,
+	             bool keepCs);
+}; //class hwSpidev
+
+/*** Hardware Dual SPI Interface *********************************************/
+//Bit-banged SPI that can also move data on two lines, IO0 = MOSI and
+//IO1 = MISO, so the pinout is the same as hwSPI. Commands and single lane
+//phases are plain hwSPI, dual phases turn the lines around as needed and
+//stop() returns them to MOSI out, MISO in
+class hwDSPI : public hwSPI {
+	public:
+	hwDSPI(int SCLK, int MOSI, int MISO, int CS, int WP, GpioMem *mem = nullptr);
+	
+	void stop() override;
+	unsigned int maxLanes() const override { return 2; }
+	
+	protected:
+	const Kernel::Lanes &prepareLanes(unsigned int lanes, bool output) override;
+	
+	//Direction of IO0 and IO1: as plain SPI, both driven, or both released
+	enum class IoDir { SINGLE, OUT, IN };
+	void setIoDir(IoDir dir);
+	IoDir ioDir = IoDir::SINGLE;
+	
+	Kernel::Lanes dualLanes;
+}; //class hwDSPI
+
+/*** Hardware Quad SPI Interface *********************************************/
+//Dual SPI plus WP as IO2 and HOLD as IO3. Outside quad phases WP keeps its
+//write protect level and HOLD is driven high. The chip's Quad Enable bit must
+//be set for IO2/IO3 to work, see splasher's dump
+class hwQSPI : public hwDSPI {
+	public:
+	hwQSPI(int SCLK, int MOSI, int MISO, int CS, int WP, int HOLD,
+	       GpioMem *mem = nullptr);
+	
+	void stop() override;
+	unsigned int maxLanes() const override { return 4; }
+	
+	//QPI (4-4-4) mode. Only changes how this side clocks, the chip is put in
+	//and out of QPI by its vendor's commands. While on, every transfer,
+	//command bytes included, runs over four lanes. QPI is half duplex, a
+	//transfer with both buffers sends tx and fills rx with 0
+	void setQpi(bool on) { qpiMode = on; }
+	bool qpi() const { return qpiMode; }
+	void transfer(const unsigned char *tx, unsigned char *rx, size_t n) override;
+	bool dummy(unsigned int cycles) override;
+	
+	protected:
+	const Kernel::Lanes &prepareLanes(unsigned int lanes, bool output) override;
+	
+	int io_HOLD;
+	bool qpiMode = false;
+	
+	//Direction of IO2 and IO3. SINGLE is WP and HOLD as outputs
+	void setQuadDir(IoDir dir);
+	IoDir quadDir = IoDir::OUT;
+	
+	Kernel::Lanes quadLanes;
+}; //class hwQSPI
 
 /*** Splasher hardware namespace **********************************************/
 namespace splasher {
 
 // Init before read: GPIO/interface ready, optionally read JEDEC into dev.jedecId
-void initRead(Device &dev, FlashInterface &hw);
-// Init before write: e.g. disable write protect on SPI
+// and dev.chip, and the SFDP parameters into dev.caps. Picks the clock when
+// dev.KHz is auto and fills dev.bytes when it is 0. Returns false if the size
+// is not known
+bool initRead(Device &dev, FlashInterface &hw);
+// Init before write: e.g. disable write protect on SPI, identify the chip as
+// initRead, read dev.caps and clear the SST26 block protection
 void initWrite(Device &dev, FlashInterface &hw);
 
 void dumpFlashToFile(Device &dev, BinFile &file);
+// Dump dev.bytes from every chip in dev.misoPins at once, one file per chip
+// named after filename, and print each chip's CRC-32
+void dumpMultiToFiles(Device &dev, const std::string &filename);
 bool readJedecId(Device &dev);
+// Dump a list of address ranges in one session. Ranges within gap bytes of
+// each other share a read command. Written to filename as a sparse image
+// at the chip addresses, or with split one file per range, e.g.
+// out.0x10000.bin
+void dumpRanges(Device &dev, std::vector<Ranges::Range> ranges, uint64_t gap,
+                const std::string &filename, bool split);
 
 // Write file content to flash (SPI 25-series). Call initWrite first; optionally erase first.
 void writeFileToFlash(Device &dev, BinFile &file);
 // Erase: full chip or from offset for byteCount bytes (sector-aligned).
-void eraseFlash(Device &dev, unsigned long byteCount = 0);
+void eraseFlash(Device &dev, uint64_t byteCount = 0);
+// Put each update's bytes at its address, leaving the rest of the chip as
+// it was: the erase units touched are read, patched in memory, and written
+// back, erasing only where bits have to go from 0 to 1
+void patchFlash(Device &dev, const std::vector<Patch::Update> &updates);
+// Ask the operation in progress to stop, the only call a signal handler
+// makes. Transfer loops and busy polls check it and return, so QPI, QE and
+// address mode are restored by their guards on the main thread
+void requestStop();
+bool stopRequested();
 
 }; //namespace splasher
 
@@ -0,0 +1,317 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gpiomem.hpp"
+#include "timing.hpp"
+#include "wave.hpp"
+#include "masktable.hpp"
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+/*** Compile-time specialised bit-bang transfer kernels ***********************/
+//A kernel moves a whole buffer, SPI mode 0, for one combination of:
+//  Port   - how pins are driven: set(mask), clr(mask), write(set, clr), lev().
+//           set/clr may be given a zero mask
+//  Delay  - timing policy between edges: low(port), high(port)
+//  LANES  - data bits per clock, 1 (SPI), 2 (dual) or 4 (quad)
+//  MSB_FIRST - bit order
+//The interface picks the kernel once per transaction, so nothing on the clock
+//edges tests the timing or the pin driver. With NoDelay the clock loop of each
+//byte is unrolled and contains no branches.
+namespace Kernel {
+	//GPIO bank 0 masks. tx[j] is the pin driven with bit j of each clock's
+	//lane value (j = 0 least significant), rxShift[j] the pin sampled for it.
+	//1 lane: tx MOSI, rx MISO. 2/4 lanes: IO0-IO3 in both directions
+	struct Lanes {
+		uint32_t sclk;
+		uint32_t tx[4];
+		uint8_t rxShift[4];
+	};
+
+	/*** Port policies ********************************************************/
+	//Direct register access through GpioMem. Stores with a zero mask still
+	//happen, they are no-ops for the hardware and cheaper than a branch
+	struct MemPort {
+		GpioMem &mem;
+
+		void set(uint32_t mask) { mem.set(mask); }
+		void clr(uint32_t mask) { mem.clr(mask); }
+		void write(uint32_t setMask, uint32_t clrMask) {
+			mem.set(setMask);
+			mem.clr(clrMask);
+		}
+		uint32_t lev() { return mem.lev(); }
+	};
+
+	//Records a DMA waveform instead of driving pins. Changes collect into a
+	//pending pulse that DmaDelay emits. MISO is sampled by DMA, lev() is 0
+	struct WavePort {
+		std::vector<Wave::Pulse> &pulses;
+		uint32_t on = 0, off = 0;
+
+		explicit WavePort(std::vector<Wave::Pulse> &out) : pulses(out) {}
+
+		void set(uint32_t mask) { on |= mask; off &= ~mask; }
+		void clr(uint32_t mask) { off |= mask; on &= ~mask; }
+		void write(uint32_t setMask, uint32_t clrMask) {
+			set(setMask);
+			clr(clrMask);
+		}
+		uint32_t lev() { return 0; }
+
+		//Close the pending pulse with a delay of us microseconds
+		void emit(uint32_t us) {
+			pulses.push_back({on, off, us});
+			on = 0;
+			off = 0;
+		}
+	};
+
+	/*** Timing policies ******************************************************/
+	//No waits, the edges run as fast as the port allows
+	struct NoDelay {
+		template<class Port> void low(Port &) const {}
+		template<class Port> void high(Port &) const {}
+	};
+
+	//Calibrated CPU spin between edges
+	struct SpinDelay {
+		Timing::Wait lowWait, highWait;
+
+		template<class Port> void low(Port &) const { Timing::delay(lowWait); }
+		template<class Port> void high(Port &) const { Timing::delay(highWait); }
+	};
+
+	//DMA timed, each half period becomes one waveform pulse. WavePort only
+	struct DmaDelay {
+		uint32_t halfUs;
+
+		void low(WavePort &port) const { port.emit(halfUs); }
+		void high(WavePort &port) const { port.emit(halfUs); }
+	};
+
+	/*** Kernel ***************************************************************/
+	template<class Port, class Delay, unsigned int LANES, bool MSB_FIRST = true>
+	struct BitKernel {
+		static_assert(LANES == 1 || LANES == 2 || LANES == 4,
+		              "Kernels support 1, 2 or 4 lanes");
+
+		static const unsigned int CLOCKS = 8 / LANES;
+		static const unsigned int LANE_MASK = (1u << LANES) - 1;
+
+		//Lane value sent or received on clock k of a byte
+		static inline unsigned int shiftFor(unsigned int k) {
+			return MSB_FIRST ? (8 - LANES * (k + 1)) : (LANES * k);
+		}
+
+		//Set and clear masks that put val on the tx lanes, without branches
+		static inline void laneMasks(const Lanes &lanes, unsigned int val,
+		                             uint32_t &setMask, uint32_t &clrMask) {
+			setMask = 0;
+			clrMask = 0;
+			for(unsigned int j = 0; j < LANES; j++) {
+				uint32_t bit = 0u - ((val >> j) & 1u);
+				setMask |= bit & lanes.tx[j];
+				clrMask |= ~bit & lanes.tx[j];
+			}
+		}
+
+		//Lane value from a GPIO level snapshot
+		static inline unsigned int sample(const Lanes &lanes, uint32_t level) {
+			unsigned int val = 0;
+			for(unsigned int j = 0; j < LANES; j++) {
+				val |= ((level >> lanes.rxShift[j]) & 1u) << j;
+			}
+			return val;
+		}
+
+		//One clock: drive the lanes, low half, rise, high half, fall.
+		//Returns the lane value sampled just before the rising edge
+		template<bool OUT, bool IN>
+		static inline unsigned int clock(Port &port, const Delay &delay,
+		                                 const Lanes &lanes, unsigned int val) {
+			if(OUT) {
+				uint32_t setMask, clrMask;
+				laneMasks(lanes, val, setMask, clrMask);
+				port.write(setMask, clrMask);
+			}
+			delay.low(port);
+			unsigned int in = IN ? sample(lanes, port.lev()) : 0;
+			port.set(lanes.sclk);
+			delay.high(port);
+			port.clr(lanes.sclk);
+			return in;
+		}
+
+		template<bool OUT, bool IN>
+		static inline unsigned char byte(Port &port, const Delay &delay,
+		                                 const Lanes &lanes, unsigned char out) {
+			unsigned int in = 0;
+			#pragma GCC unroll 8
+			for(unsigned int k = 0; k < CLOCKS; k++) {
+				unsigned int shift = shiftFor(k);
+				unsigned int val = clock<OUT, IN>(port, delay, lanes,
+				                                  (out >> shift) & LANE_MASK);
+				in |= val << shift;
+			}
+			return static_cast<unsigned char>(in);
+		}
+
+		//Transmit n bytes
+		static void tx(Port &port, const Delay &delay, const Lanes &lanes,
+		               const unsigned char *buf, size_t n) {
+			for(size_t i = 0; i < n; i++) {
+				byte<true, false>(port, delay, lanes, buf[i]);
+			}
+		}
+
+		//Receive n bytes, the tx lanes are not driven
+		static void rx(Port &port, const Delay &delay, const Lanes &lanes,
+		               unsigned char *buf, size_t n) {
+			for(size_t i = 0; i < n; i++) {
+				buf[i] = byte<false, true>(port, delay, lanes, 0);
+			}
+		}
+
+		//Transmit and receive n bytes at the same time
+		static void xfer(Port &port, const Delay &delay, const Lanes &lanes,
+		                 const unsigned char *txBuf, unsigned char *rxBuf,
+		                 size_t n) {
+			for(size_t i = 0; i < n; i++) {
+				rxBuf[i] = byte<true, true>(port, delay, lanes, txBuf[i]);
+			}
+		}
+
+		//Clock n bytes without driving or sampling the lanes (dummy cycles)
+		static void skip(Port &port, const Delay &delay, const Lanes &lanes,
+		                 size_t n) {
+			for(size_t i = 0; i < n; i++) {
+				byte<false, false>(port, delay, lanes, 0);
+			}
+		}
+
+		//Clock n bytes without driving the tx lanes, storing the raw level
+		//snapshot taken before each rising edge, CLOCKS per byte. The loop
+		//does no bit work, Gather decodes the block afterwards
+		static void capture(Port &port, const Delay &delay, const Lanes &lanes,
+		                    uint32_t *levels, size_t n) {
+			for(size_t i = 0; i < n; i++) {
+				#pragma GCC unroll 8
+				for(unsigned int k = 0; k < CLOCKS; k++) {
+					delay.low(port);
+					*levels++ = port.lev();
+					port.set(lanes.sclk);
+					delay.high(port);
+					port.clr(lanes.sclk);
+				}
+			}
+		}
+
+		//Pick tx, rx, xfer or skip from which buffers are given
+		static void run(Port &port, const Delay &delay, const Lanes &lanes,
+		                const unsigned char *txBuf, unsigned char *rxBuf,
+		                size_t n) {
+			if(txBuf == nullptr && rxBuf == nullptr) {
+				skip(port, delay, lanes, n);
+			} else if(txBuf == nullptr) {
+				rx(port, delay, lanes, rxBuf, n);
+			} else if(rxBuf == nullptr) {
+				tx(port, delay, lanes, txBuf, n);
+			} else {
+				xfer(port, delay, lanes, txBuf, rxBuf, n);
+			}
+		}
+	}; //struct BitKernel
+
+	//Double transfer rate: LANES bits on each clock edge, so a byte takes
+	//8 / (2 * LANES) clocks. Transmit changes the lanes while SCLK is high so
+	//the chip samples on both edges. Receive samples before each edge, the
+	//chip drives new data after every edge
+	template<class Port, class Delay, unsigned int LANES>
+	struct DtrKernel {
+		typedef BitKernel<Port, Delay, LANES> Base;
+		static const unsigned int HALVES = 8 / LANES;
+
+		static inline void txByte(Port &port, const Delay &delay,
+		                          const Lanes &lanes, unsigned char out) {
+			#pragma GCC unroll 8
+			for(unsigned int h = 0; h < HALVES; h += 2) {
+				uint32_t setMask, clrMask;
+				Base::laneMasks(lanes, (out >> Base::shiftFor(h)) & Base::LANE_MASK,
+				                setMask, clrMask);
+				port.write(setMask, clrMask);
+				delay.low(port);
+				port.set(lanes.sclk);
+				Base::laneMasks(lanes, (out >> Base::shiftFor(h + 1)) & Base::LANE_MASK,
+				                setMask, clrMask);
+				port.write(setMask, clrMask);
+				delay.high(port);
+				port.clr(lanes.sclk);
+			}
+		}
+
+		static inline unsigned char rxByte(Port &port, const Delay &delay,
+		                                   const Lanes &lanes) {
+			unsigned int in = 0;
+			#pragma GCC unroll 8
+			for(unsigned int h = 0; h < HALVES; h += 2) {
+				delay.low(port);
+				in |= Base::sample(lanes, port.lev()) << Base::shiftFor(h);
+				port.set(lanes.sclk);
+				delay.high(port);
+				in |= Base::sample(lanes, port.lev()) << Base::shiftFor(h + 1);
+				port.clr(lanes.sclk);
+			}
+			return static_cast<unsigned char>(in);
+		}
+
+		//Transmit or receive n bytes, whichever buffer is given
+		static void run(Port &port, const Delay &delay, const Lanes &lanes,
+		                const unsigned char *txBuf, unsigned char *rxBuf,
+		                size_t n) {
+			if(txBuf != nullptr) {
+				for(size_t i = 0; i < n; i++) txByte(port, delay, lanes, txBuf[i]);
+			} else if(rxBuf != nullptr) {
+				for(size_t i = 0; i < n; i++) rxBuf[i] = rxByte(port, delay, lanes);
+			}
+		}
+	}; //struct DtrKernel
+
+	//Single lane transmit from a MaskTable, two or three stores per bit
+	//instead of a data store plus a set/clear pair
+	template<class Port, class Delay>
+	struct TableKernel {
+		static void tx(Port &port, const Delay &delay,
+		               const MaskTable::Table &table, uint32_t sclk,
+		               const unsigned char *buf, size_t n) {
+			for(size_t i = 0; i < n; i++) {
+				const MaskTable::ByteStores &stores = table.byte[buf[i]];
+				port.clr(stores.lead);
+
+				#pragma GCC unroll 8
+				for(unsigned int k = 0; k < 8; k++) {
+					port.set(stores.bit[k].set);
+					delay.low(port);
+					port.set(sclk);
+					delay.high(port);
+					port.clr(stores.bit[k].clr);
+				}
+			}
+		}
+	}; //struct TableKernel
+} //namespace Kernel
+
+#endif
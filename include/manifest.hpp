@@ -0,0 +1,55 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "filemanager.hpp"
+
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+/*** Write manifests **********************************************************/
+//What a write left on the chip: an XXH64 of each erase unit, with the chip's
+//JEDEC and unique IDs. A later write checks its image against this on the
+//host, and only touches the units whose hash changed. Saved as text:
+//
+//  splasher-manifest 1
+//  jedec ef4018
+//  uid d2661c3447284d2a    (- when the chip has none)
+//  offset 0
+//  bytes 4194304
+//  unit 4096
+//  hashes 1024
+//  <one 16 digit hash per line>
+struct Manifest {
+	std::string jedec;      // 6 hex digits
+	std::string uid;        // Hex, empty when the chip has no unique ID
+	uint64_t offset = 0;    // Range written, [offset, offset + bytes)
+	uint64_t bytes = 0;
+	uint32_t unit = 0;      // Erase unit size the hashes are over
+	//Unit i starts at unitStart(i), its hash covers the part inside the range
+	std::vector<uint64_t> hashes;
+	
+	uint64_t unitStart(size_t i) const { return offset - offset % unit + uint64_t(i) * unit; }
+	
+	//Hash the image in file, from its start, as written at offset. bytes is
+	//cut down to the length of the file. Leaves the file at its end
+	void hashImage(BinFile &file, uint64_t offset, uint64_t bytes, uint32_t unit);
+	
+	//Both print the error and return false on failure
+	bool save(const std::string &filename) const;
+	bool load(const std::string &filename);
+}; //struct Manifest
+
+#endif
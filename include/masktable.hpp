@@ -0,0 +1,60 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstdint>
+
+#ifndef MASKTABLE_H
+#define MASKTABLE_H
+
+/*** Byte to GPIO store tables for single lane transmit ***********************/
+//Every byte value maps to the GPSET/GPCLR masks that clock it out MSBFirst.
+//For each bit:
+//  GPSET = set    MOSI high, only when the bit is 1 (0 mask otherwise)
+//  GPSET = SCLK   rising edge
+//  GPCLR = clr    falling edge, combined with MOSI low when the next bit is 0
+//lead clears MOSI before bit 7 when it is 0. A bit costs at most three
+//stores, and a 0 following a 1 is set up by the falling edge for free.
+namespace MaskTable {
+	struct BitStores {
+		uint32_t set;
+		uint32_t clr;
+	};
+
+	struct ByteStores {
+		uint32_t lead;
+		BitStores bit[8];
+	};
+
+	struct Table {
+		ByteStores byte[256];
+	};
+
+	//Build the table for a MOSI and SCLK pin mask. constexpr, so the table
+	//for the default pinout is generated by the compiler
+	constexpr Table build(const uint32_t mosiMask, const uint32_t sclkMask) {
+		Table table{};
+		for(unsigned int val = 0; val < 256; val++) {
+			table.byte[val].lead = (val & 0x80) ? 0 : mosiMask;
+
+			for(unsigned int k = 0; k < 8; k++) {
+				bool bit = (val >> (7 - k)) & 0x01;
+				//MOSI is left as-is after the last bit, the next lead fixes it
+				bool nextZero = (k < 7) && !((val >> (6 - k)) & 0x01);
+
+				table.byte[val].bit[k].set = bit ? mosiMask : 0;
+				table.byte[val].bit[k].clr = sclkMask | (nextZero ? mosiMask : 0);
+			}
+		}
+		return table;
+	}
+} //namespace MaskTable
+
+#endif
@@ -0,0 +1,39 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef PATCH_H
+#define PATCH_H
+
+/*** Patch lists **************************************************************/
+//Small in-place updates, e.g. a MAC address, a serial number or an env
+//block, given as bytes to put at an address. The chip side, reading the
+//erase units around them and writing them back, is splasher::patchFlash()
+namespace Patch {
+	struct Update {
+		uint64_t addr;
+		std::vector<unsigned char> data;
+		uint64_t end() const { return addr + data.size(); }
+	};
+	
+	//Parse a comma separated list of ADDR=HEX, the bytes given in hex with
+	//optional ':' separators, or a bare ADDR, which puts the whole of
+	//filename there. e.g. 0x3FF000=00:16:3e:5a:1b:2c,0x3F800. Prints the
+	//error and returns false if the list is not valid
+	bool parse(const std::string &list, const std::string &filename,
+	           std::vector<Update> &updates);
+} //namespace Patch
+
+#endif
@@ -0,0 +1,55 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef RANGES_H
+#define RANGES_H
+
+/*** Range list reads *********************************************************/
+//Address ranges to dump, and the read commands that cover them. Ranges are
+//sorted, and any that overlap or lie within gap bytes of each other share one
+//read, so the gap bytes are read rather than paying for a new command
+namespace Ranges {
+	struct Range {
+		uint64_t start;
+		uint64_t bytes;
+		uint64_t end() const { return start + bytes; }
+	};
+
+	//One read command, and the ranges it covers as indices into the sorted
+	//range list
+	struct Read {
+		uint64_t start;
+		uint64_t bytes;
+		std::vector<size_t> parts;
+		uint64_t end() const { return start + bytes; }
+	};
+
+	//Decimal or 0x hex, with an optional K or M multiplier. Values above
+	//4 GiB are refused, well past any 25-series part
+	bool parseSize(std::string text, uint64_t &value);
+
+	//Parse a comma separated list of START+LENGTH or START-END (END not
+	//included). Numbers are decimal or 0x hex, with an optional K or M
+	//suffix, e.g. 0+64K,0x3F0000-4M. Prints the error and returns false if
+	//the list is not valid
+	bool parse(const std::string &list, std::vector<Range> &ranges);
+
+	//Sort ranges by start and group them into reads. Ranges that overlap or
+	//are at most gap bytes apart go in the same read
+	std::vector<Read> coalesce(std::vector<Range> &ranges, uint64_t gap);
+} //namespace Ranges
+
+#endif
@@ -0,0 +1,84 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+/*** Real-time execution for the transfer thread ******************************/
+//A preemption in the middle of a byte stretches the bit-banged clock. In
+//realtime mode the thread doing the transfer is pinned to one core, runs
+//SCHED_FIFO and has its memory locked, and progress printing moves to its own
+//thread so the console never blocks the clock loop.
+namespace Realtime {
+	const int FIFO_PRIORITY = 50;        // Above pigpio's threads, below IRQs
+	const uint32_t PROGRESS_MS = 250;    // Progress line refresh period
+	const double OVERRUN_MARGIN = 1.10;  // Chunk may take 10% over its budget
+
+	//Move the calling thread to cpu (-1 leaves affinity alone), SCHED_FIFO
+	//and lock all memory. Each step that fails prints a warning, returns
+	//false if any did
+	bool enter(int cpu);
+	//Return the calling thread to SCHED_OTHER and unlock memory
+	void leave();
+
+	//Prints "\r<label> N KiB<suffix>" from another thread while the transfer
+	//updates a counter. stop() prints the final value
+	class Progress {
+		public:
+		Progress(const std::string &label, const std::string &suffix = "");
+		~Progress();
+
+		void update(unsigned long bytes) {
+			done.store(bytes, std::memory_order_relaxed);
+		}
+		void stop();
+
+		private:
+		void print();
+
+		std::string label, suffix;
+		std::atomic<unsigned long> done;
+		std::atomic<bool> running;
+		std::thread worker;
+	}; //class Progress
+
+	//Counts chunks that took longer than the clock rate allows
+	class OverrunCounter {
+		public:
+		//KHz is the measured clock, 0 disables counting. clocksPerByte is
+		//8 for single lane reads, 8 / lanes for wide ones, halved for DTR
+		explicit OverrunCounter(unsigned int KHz, unsigned int clocksPerByte = 8)
+			: KHz(KHz), clocksPerByte(clocksPerByte) {}
+
+		//Time one chunk of bytes, between begin() and end()
+		void begin();
+		void end(unsigned long bytes);
+
+		unsigned long overruns() const { return count; }
+		unsigned long chunks() const { return total; }
+		//Worst time over budget, in microseconds
+		uint64_t worstUs() const { return worstNs / 1000; }
+
+		private:
+		unsigned int KHz;
+		unsigned int clocksPerByte;
+		uint64_t started = 0;
+		unsigned long count = 0, total = 0;
+		uint64_t worstNs = 0;
+	}; //class OverrunCounter
+} //namespace Realtime
+
+#endif
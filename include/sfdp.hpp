@@ -0,0 +1,107 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef SFDP_H
+#define SFDP_H
+
+/*** Chip capabilities ********************************************************/
+//What a chip reports about itself through Read SFDP (0x5A). Fields the chip
+//does not report keep the defaults, which are the plain 25-series behaviour
+struct FlashCaps {
+	//A fast read mode, named command-address-data lanes, e.g. 1-4-4.
+	//modeClocks are the mode bit clocks after the address, counted separately
+	//from the dummy clocks that follow them
+	struct Read {
+		bool supported = false;
+		unsigned char cmd = 0;
+		unsigned int addrLanes = 1;
+		unsigned int dataLanes = 1;
+		unsigned int modeClocks = 0;
+		unsigned int dummyClocks = 0;
+	};
+
+	//One of up to four erase sizes, bytes is 0 when the type is unused
+	struct Erase {
+		uint32_t bytes = 0;
+		unsigned char cmd = 0;
+	};
+
+	//Where the Quad Enable bit is, JESD216 DWORD 15 bits 22:20
+	//  NONE              no QE bit, quad is always available
+	//  SR2_BIT1          status register 2 bit 1, read with 0x35 and
+	//                    written as 0x01 SR1 SR2 (QER 4, 5)
+	//  SR2_BIT1_NO_READ  the same, but SR2 cannot be read (QER 1), not handled
+	//  SR2_BIT1_WRSR2    status register 2 bit 1, read with 0x35 and written
+	//                    on its own as 0x31 SR2 (QER 6)
+	//  SR1_BIT6          status register bit 6, written as 0x01 SR
+	//  SR2_BIT7          status register 2 bit 7 through 0x3F/0x3E, not handled
+	enum class QE { UNKNOWN, NONE, SR2_BIT1, SR2_BIT1_NO_READ, SR2_BIT1_WRSR2,
+	                SR1_BIT6, SR2_BIT7 };
+
+	bool valid = false;           // An SFDP Basic Flash Parameter Table was read
+	unsigned int revMajor = 0;
+	unsigned int revMinor = 0;
+	uint64_t bytes = 0;           // Density, 0 when unknown
+	unsigned int pageSize = 256;
+	Read read112, read122, read114, read144;
+	Erase erase[4];
+	bool addr3 = true;            // Accepts 3-byte addresses
+	bool addr4 = false;           // Accepts 4-byte addresses
+	bool enter4Cmd = false;       // 0xB7 enters 4-byte mode (maybe after 0x06)
+	bool enter4Ear = false;       // Extended address register 0xC5/0xC8
+	bool opcodes4 = false;        // Dedicated 4-byte address commands
+	QE qe = QE::UNKNOWN;
+
+	//Smallest erase type, or nullptr if none is defined
+	const Erase *smallestErase() const;
+	//Read mode using opcode cmd, or nullptr
+	const Read *findRead(unsigned char cmd) const;
+	//One line summary for the console
+	std::string describe() const;
+}; //struct FlashCaps
+
+/*** SFDP parsing *************************************************************/
+//Byte level decoding only, the reads go through the flash interface. Layout:
+//  0x00  SFDP header, 8 bytes: "SFDP", revision, parameter header count - 1
+//  0x08  parameter headers, 8 bytes each: ID, revision, length, pointer
+//  ...   parameter tables, found through their pointer
+namespace Sfdp {
+	const unsigned char READ_CMD = 0x5A;
+	const unsigned int DUMMY_CLOCKS = 8;
+	const unsigned int HEADER_BYTES = 8;        // Also each parameter header
+	const uint16_t BFPT_ID = 0xFF00;            // Basic Flash Parameter Table
+	const unsigned int BFPT_MAX_DWORDS = 64;
+
+	struct Table {
+		uint16_t id;
+		unsigned int revMajor;
+		unsigned int revMinor;
+		unsigned int dwords;
+		uint32_t pointer;
+	};
+
+	//Check the SFDP header. Returns the number of parameter headers that
+	//follow it, 0 if the signature is wrong
+	unsigned int parseHeader(const unsigned char *buf, FlashCaps &caps);
+
+	//Decode one parameter header
+	Table parseTable(const unsigned char *buf);
+
+	//Decode a Basic Flash Parameter Table of dwords DWORDs into caps.
+	//Returns false if it is too short to use
+	bool parseBfpt(const unsigned char *buf, unsigned int dwords, FlashCaps &caps);
+} //namespace Sfdp
+
+#endif
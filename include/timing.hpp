@@ -0,0 +1,64 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstdint>
+
+#ifndef TIMING_H
+#define TIMING_H
+
+/*** Calibrated busy-wait timing **********************************************/
+//Replaces gpioDelay() in the bit-bang loops. gpioDelay() cannot wait less than
+//1us, so half periods collapse to whole microseconds. Short waits here spin a
+//loop calibrated against CLOCK_MONOTONIC at startup, longer waits poll the
+//clock itself so they stay accurate if the CPU frequency changes.
+namespace Timing {
+	const uint32_t MIN_NS = 50;          // Shortest wait that is honoured
+	const uint32_t MAX_NS = 1000000;     // Longest wait (1ms)
+	const uint32_t CLOCK_POLL_NS = 2000; // Waits from here on poll the clock
+
+	//A precomputed wait. Converting ns to loops is done once in setTiming(),
+	//not on every clock edge
+	struct Wait {
+		uint32_t ns = 0;
+		uint32_t loops = 0;
+	};
+
+	//Measure the spin loop rate. Runs once, later calls return immediately
+	void calibrate();
+	//Calibrated spin loop iterations per microsecond
+	double loopsPerUs();
+
+	//Build a Wait for ns nanoseconds, clamped to MAX_NS. 0 means no wait
+	Wait makeWait(uint32_t ns);
+
+	//Monotonic clock in nanoseconds
+	uint64_t nowNs();
+
+	//Spin for a number of loop iterations, the compiler may not remove it
+	inline void spin(uint32_t loops) {
+		while(loops--) __asm__ __volatile__("" ::: "memory");
+	}
+
+	//Poll the monotonic clock until ns nanoseconds have passed
+	void pollNs(uint32_t ns);
+
+	//Wait for a precomputed Wait, inline as it sits between clock edges
+	inline void delay(const Wait &wait) {
+		if(wait.ns == 0) return;
+		if(wait.ns >= CLOCK_POLL_NS) {
+			pollNs(wait.ns);
+		} else {
+			spin(wait.loops);
+		}
+	}
+} //namespace Timing
+
+#endif
@@ -0,0 +1,70 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef WAVE_H
+#define WAVE_H
+
+/*** DMA waveform construction and MISO decoding ******************************/
+//Hardware independent half of the DMA timed SPI interface (hwWaveSPI). The
+//pulse and sample structs have the same layout as pigpio's gpioPulse_t and
+//gpioSample_t, so these can be built and tested without pigpio.
+namespace Wave {
+	//One waveform step: set the on mask, clear the off mask, then wait us
+	struct Pulse {
+		uint32_t on;
+		uint32_t off;
+		uint32_t us;
+	};
+
+	//One DMA level sample of GPIO 0-31, tick in microseconds
+	struct Sample {
+		uint32_t tick;
+		uint32_t level;
+	};
+
+	//Append the SPI mode 0 waveform for n bytes to pulses, MSBFirst. Each bit
+	//is a low phase (MOSI set up, SCLK low) and a high phase, halfUs each,
+	//followed by a final SCLK low. If tx is nullptr MOSI is not driven.
+	void buildPulses(const unsigned char *tx, size_t n, uint32_t mosiMask,
+	                 uint32_t sclkMask, unsigned int halfUs,
+	                 std::vector<Pulse> &pulses);
+
+	//Rebuilds received bytes from the sampled GPIO levels. MISO is taken from
+	//the last sample of each SCLK high phase, so the decoder needs no absolute
+	//timing, only samples at least twice per half period.
+	class MisoDecoder {
+		public:
+		//Expect bits SCLK cycles from now, written MSBFirst into rx
+		void reset(uint32_t sclkMask, uint32_t misoMask, size_t bits,
+		           unsigned char *rx);
+
+		//Feed samples in time order. Returns true once every bit is decoded
+		bool feed(const Sample *samples, size_t count);
+
+		bool done() const { return bitsDone >= bitsWanted; }
+		size_t decodedBits() const { return bitsDone; }
+
+		private:
+		uint32_t sclk = 0, miso = 0;
+		size_t bitsWanted = 0, bitsDone = 0;
+		unsigned char *out = nullptr;
+
+		bool sclkHigh = false;
+		bool misoLevel = false;
+		unsigned char acc = 0;
+	}; //class MisoDecoder
+} //namespace Wave
+
+#endif
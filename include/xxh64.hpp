@@ -0,0 +1,23 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+
+#ifndef XXH64_H
+#define XXH64_H
+
+/*** XXH64 (xxHash, 64-bit) ***************************************************/
+//Fast non-cryptographic hash, the same values as xxhsum -H64. Used to tell
+//whether an erase unit has changed, not to detect tampering
+uint64_t xxh64(const unsigned char *data, size_t n, uint64_t seed = 0);
+
+#endif
@@ -0,0 +1,112 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstdint>
+#include <cstring>
+
+#include "blank.hpp"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define BLANK_NEON
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define BLANK_X86
+#endif
+
+namespace Blank {
+
+//Bytes ANDed together between checks. A page of data usually fails in the
+//first block, padding has to be read to the end either way
+static const size_t BLOCK = 64;
+
+bool isErasedScalar(const unsigned char *buf, size_t n) {
+	size_t i = 0;
+	for(; i + 8 <= n; i += 8) {
+		uint64_t word;
+		memcpy(&word, buf + i, 8);
+		if(word != UINT64_MAX) return false;
+	}
+	for(; i < n; i++) {
+		if(buf[i] != 0xFF) return false;
+	}
+	return true;
+}
+
+#if defined(BLANK_NEON)
+static bool isErasedNeon(const unsigned char *buf, size_t n) {
+	size_t i = 0;
+	for(; i + BLOCK <= n; i += BLOCK) {
+		uint8x16_t acc = vandq_u8(vandq_u8(vld1q_u8(buf + i), vld1q_u8(buf + i + 16)),
+		                          vandq_u8(vld1q_u8(buf + i + 32), vld1q_u8(buf + i + 48)));
+		uint64x2_t words = vreinterpretq_u64_u8(acc);
+		if((vgetq_lane_u64(words, 0) & vgetq_lane_u64(words, 1)) != UINT64_MAX) {
+			return false;
+		}
+	}
+	return isErasedScalar(buf + i, n - i);
+}
+#endif
+
+#if defined(BLANK_X86)
+static bool isErasedSse2(const unsigned char *buf, size_t n) {
+	const __m128i *p = reinterpret_cast<const __m128i *>(buf);
+	size_t i = 0;
+	for(; i + BLOCK <= n; i += BLOCK, p += 4) {
+		__m128i acc = _mm_and_si128(_mm_and_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+		                            _mm_and_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+		if(_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_set1_epi8(-1))) != 0xFFFF) {
+			return false;
+		}
+	}
+	return isErasedScalar(buf + i, n - i);
+}
+
+//testc is set when no bit of ones is clear in acc
+__attribute__((target("avx2")))
+static bool isErasedAvx2(const unsigned char *buf, size_t n) {
+	const __m256i ones = _mm256_set1_epi8(-1);
+	const __m256i *p = reinterpret_cast<const __m256i *>(buf);
+	size_t i = 0;
+	for(; i + BLOCK <= n; i += BLOCK, p += 2) {
+		__m256i acc = _mm256_and_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1));
+		if(!_mm256_testc_si256(acc, ones)) return false;
+	}
+	return isErasedScalar(buf + i, n - i);
+}
+
+static bool haveAvx2() {
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	return avx2;
+}
+#endif
+
+bool isErased(const unsigned char *buf, size_t n) {
+	#if defined(BLANK_NEON)
+	return isErasedNeon(buf, n);
+	#elif defined(BLANK_X86)
+	return haveAvx2() ? isErasedAvx2(buf, n) : isErasedSse2(buf, n);
+	#else
+	return isErasedScalar(buf, n);
+	#endif
+}
+
+const char *implName() {
+	#if defined(BLANK_NEON)
+	return "NEON";
+	#elif defined(BLANK_X86)
+	return haveAvx2() ? "AVX2" : "SSE2";
+	#else
+	return "scalar";
+	#endif
+}
+
+} //namespace Blank
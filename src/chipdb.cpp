@@ -0,0 +1,358 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <algorithm>
+#include <array>
+
+#include "chipdb.hpp"
+
+namespace ChipDb {
+
+/*** Family timings ***********************************************************/
+//Datasheet figures, the slowest part of each family where they differ
+//                         ppTyp  ppMax  seTyp seMax  beTyp beMax  ceTyp  ceMax
+const Timing GENERIC_TIMING = {700, 5000,   60,  500,   500, 3000,  5000, 20000};
+static const Timing WINBOND =  {400, 3000,   45,  400,   150, 2000,  2500, 12500};
+static const Timing WINBOND_X = {1500, 3000, 150,  300,  1000, 2000, 12500, 25000};
+static const Timing MACRONIX = {1000, 5000,   60,  300,   500, 2000,  5000, 10000};
+static const Timing MACRONIX_LP = {850, 4000, 40,  240,   600, 3500,  6250, 30000};
+static const Timing GIGADEVICE = {600, 2400,  50,  400,   250, 1600,  3750, 15625};
+static const Timing ISSI =     {200,  800,   70,  300,   300, 1000,  2500,  8000};
+static const Timing MICRON =   {500, 5000,  300,  800,   700, 3000, 10625, 15625};
+static const Timing M25P =     {800, 5000,    0,    0,  1000, 3000,  8000, 24000};
+static const Timing SPANSION = {400, 2000,  200,  650,   500, 2600,  3000, 12000};
+static const Timing SST25 =    {  7,   10,   18,   25,    18,   25,    20,    25};
+static const Timing SST26 =    {1000, 1500,  18,   25,    18,   25,    18,    25};
+static const Timing ATMEL_DF = {1000, 5000,  50,  200,   400,  950,  9000, 14000};
+static const Timing ADESTO_SF = {400, 2500,  60,  300,   450, 3000,  7500, 15000};
+static const Timing EON =      {1300, 5000,  90,  300,   500, 2000,  5000, 12500};
+
+/*** Parts ********************************************************************/
+static const uint32_t KIB = 1024;
+static const uint32_t MIB = 1048576;
+
+static const uint8_t E_STD = ERASE_4K | ERASE_32K | ERASE_64K;
+static const uint8_t E_4K_64K = ERASE_4K | ERASE_64K;
+
+using namespace Quirk;
+
+//Grouped by vendor for editing, the compiler sorts it by ID
+static constexpr Chip LIST[] = {
+	//Winbond
+	{0xEF3011, "W25X10",     128 * KIB, 256, E_4K_64K, 33,  75, &WINBOND_X, NO_QUAD},
+	{0xEF3012, "W25X20",     256 * KIB, 256, E_4K_64K, 33,  75, &WINBOND_X, NO_QUAD},
+	{0xEF3013, "W25X40",     512 * KIB, 256, E_4K_64K, 33,  75, &WINBOND_X, NO_QUAD},
+	{0xEF3014, "W25X80",       1 * MIB, 256, E_4K_64K, 33,  75, &WINBOND_X, NO_QUAD},
+	{0xEF3015, "W25X16",       2 * MIB, 256, E_4K_64K, 33,  75, &WINBOND_X, NO_QUAD},
+	{0xEF3016, "W25X32",       4 * MIB, 256, E_4K_64K, 33,  75, &WINBOND_X, NO_QUAD},
+	{0xEF3017, "W25X64",       8 * MIB, 256, E_4K_64K, 33,  75, &WINBOND_X, NO_QUAD},
+	{0xEF4011, "W25Q10",     128 * KIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF4012, "W25Q20",     256 * KIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF4013, "W25Q40",     512 * KIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF4014, "W25Q80",       1 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF4015, "W25Q16",       2 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF4016, "W25Q32",       4 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF4017, "W25Q64",       8 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF4018, "W25Q128",     16 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF4019, "W25Q256",     32 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | ADDR4_ENTER},
+	{0xEF4020, "W25Q512JV",   64 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | ADDR4_OPCODES},
+	{0xEF4021, "W25Q01JV",   128 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | ADDR4_OPCODES},
+	{0xEF6012, "W25Q20EW",   256 * KIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF6013, "W25Q40EW",   512 * KIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF6014, "W25Q80EW",     1 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF6015, "W25Q16FW",     2 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF6016, "W25Q32FW",     4 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF6017, "W25Q64FW",     8 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF6018, "W25Q128FW",   16 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1},
+	{0xEF6019, "W25Q256JW",   32 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | ADDR4_ENTER},
+	{0xEF6020, "W25Q512NW",   64 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | ADDR4_OPCODES},
+	{0xEF7015, "W25Q16JV-DTR",  2 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR},
+	{0xEF7016, "W25Q32JV-DTR",  4 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR},
+	{0xEF7017, "W25Q64JV-DTR",  8 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR},
+	{0xEF7018, "W25Q128JV-DTR", 16 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR},
+	{0xEF7019, "W25Q256JV-DTR", 32 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR | ADDR4_OPCODES},
+	{0xEF7020, "W25Q512JV-DTR", 64 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR | ADDR4_OPCODES},
+	{0xEF8016, "W25Q32JW-DTR",  4 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR},
+	{0xEF8017, "W25Q64JW-DTR",  8 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR},
+	{0xEF8018, "W25Q128JW-DTR", 16 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR},
+	{0xEF8019, "W25Q256JW-DTR", 32 * MIB, 256, E_STD, 50, 104, &WINBOND, QE_SR2_BIT1 | DTR | ADDR4_ENTER},
+
+	//Macronix. The MX25L IDs are shared with older parts that have no quad
+	//and no SFDP, newer ones report quad through SFDP
+	{0xC22010, "MX25L512",   64 * KIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22011, "MX25L1005",  128 * KIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22012, "MX25L2005",  256 * KIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22013, "MX25L4005",  512 * KIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22014, "MX25L8005",    1 * MIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22015, "MX25L1605",    2 * MIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22016, "MX25L3205",    4 * MIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22017, "MX25L6405",    8 * MIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22018, "MX25L12805",  16 * MIB, 256, E_4K_64K, 33, 86, &MACRONIX, QE_SR1_BIT6 | NO_QUAD},
+	{0xC22019, "MX25L25635",  32 * MIB, 256, E_STD, 33, 86, &MACRONIX, QE_SR1_BIT6 | ADDR4_ENTER},
+	{0xC2201A, "MX25L51245G", 64 * MIB, 256, E_STD, 50, 104, &MACRONIX, QE_SR1_BIT6 | ADDR4_OPCODES},
+	{0xC2201B, "MX66L1G45G", 128 * MIB, 256, E_STD, 50, 104, &MACRONIX, QE_SR1_BIT6 | ADDR4_OPCODES},
+	{0xC22313, "MX25V4035F", 512 * KIB, 256, E_STD, 33, 80, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22314, "MX25V8035F",   1 * MIB, 256, E_STD, 33, 80, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22315, "MX25V1635F",   2 * MIB, 256, E_STD, 33, 80, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22532, "MX25U2033E", 256 * KIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22533, "MX25U4035",  512 * KIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22534, "MX25U8035",    1 * MIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22535, "MX25U1635",    2 * MIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22536, "MX25U3235",    4 * MIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22537, "MX25U6435",    8 * MIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22538, "MX25U12835",  16 * MIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22539, "MX25U25635",  32 * MIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6 | ADDR4_ENTER},
+	{0xC2253A, "MX25U51245",  64 * MIB, 256, E_STD, 50, 104, &MACRONIX_LP, QE_SR1_BIT6 | ADDR4_OPCODES},
+	//MX25R run in low power mode unless switched, 33 MHz there
+	{0xC22810, "MX25R512F",   64 * KIB, 256, E_STD, 33, 33, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22811, "MX25R1035F", 128 * KIB, 256, E_STD, 33, 33, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22812, "MX25R2035F", 256 * KIB, 256, E_STD, 33, 33, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22813, "MX25R4035F", 512 * KIB, 256, E_STD, 33, 33, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22814, "MX25R8035F",   1 * MIB, 256, E_STD, 33, 33, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22815, "MX25R1635F",   2 * MIB, 256, E_STD, 33, 33, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22816, "MX25R3235F",   4 * MIB, 256, E_STD, 33, 33, &MACRONIX_LP, QE_SR1_BIT6},
+	{0xC22817, "MX25R6435F",   8 * MIB, 256, E_STD, 33, 33, &MACRONIX_LP, QE_SR1_BIT6},
+
+	//GigaDevice
+	{0xC84010, "GD25Q512",    64 * KIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84011, "GD25Q10",    128 * KIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84012, "GD25Q20",    256 * KIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84013, "GD25Q40",    512 * KIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84014, "GD25Q80",      1 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84015, "GD25Q16",      2 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84016, "GD25Q32",      4 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84017, "GD25Q64",      8 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84018, "GD25Q128",    16 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC84019, "GD25Q256",    32 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1 | ADDR4_ENTER},
+	{0xC84020, "GD25Q512MC",  64 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1 | ADDR4_ENTER},
+	{0xC86012, "GD25LQ20",   256 * KIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86013, "GD25LQ40",   512 * KIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86014, "GD25LQ80",     1 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86015, "GD25LQ16",     2 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86016, "GD25LQ32",     4 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86017, "GD25LQ64",     8 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86018, "GD25LQ128",   16 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86513, "GD25WQ40",   512 * KIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86514, "GD25WQ80",     1 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86515, "GD25WQ16",     2 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86516, "GD25WQ32",     4 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86517, "GD25WQ64",     8 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+	{0xC86518, "GD25WQ128",   16 * MIB, 256, E_STD, 50, 104, &GIGADEVICE, QE_SR2_BIT1},
+
+	//ISSI
+	{0x9D4013, "IS25LQ040",  512 * KIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D4014, "IS25LQ080",    1 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D4015, "IS25LQ016",    2 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D4016, "IS25LQ032",    4 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6011, "IS25LP010",  128 * KIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6012, "IS25LP020",  256 * KIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6013, "IS25LP040",  512 * KIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6014, "IS25LP080",    1 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6015, "IS25LP016",    2 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6016, "IS25LP032",    4 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6017, "IS25LP064",    8 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6018, "IS25LP128",   16 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D6019, "IS25LP256",   32 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6 | ADDR4_ENTER},
+	{0x9D601A, "IS25LP512",   64 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6 | ADDR4_ENTER},
+	{0x9D601B, "IS25LP01G",  128 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6 | ADDR4_ENTER},
+	{0x9D7012, "IS25WP020",  256 * KIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D7013, "IS25WP040",  512 * KIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D7014, "IS25WP080",    1 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D7015, "IS25WP016",    2 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D7016, "IS25WP032",    4 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D7017, "IS25WP064",    8 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D7018, "IS25WP128",   16 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6},
+	{0x9D7019, "IS25WP256",   32 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6 | ADDR4_ENTER},
+	{0x9D701A, "IS25WP512",   64 * MIB, 256, E_STD, 50, 104, &ISSI, QE_SR1_BIT6 | ADDR4_ENTER},
+
+	//ST / Numonyx / Micron. M25P128 has 256 KiB sectors, M25P no 4 KiB erase
+	{0x202012, "M25P20",     256 * KIB, 256, ERASE_64K, 20, 50, &M25P, NO_DUAL | NO_QUAD},
+	{0x202013, "M25P40",     512 * KIB, 256, ERASE_64K, 20, 50, &M25P, NO_DUAL | NO_QUAD},
+	{0x202014, "M25P80",       1 * MIB, 256, ERASE_64K, 20, 50, &M25P, NO_DUAL | NO_QUAD},
+	{0x202015, "M25P16",       2 * MIB, 256, ERASE_64K, 20, 50, &M25P, NO_DUAL | NO_QUAD},
+	{0x202016, "M25P32",       4 * MIB, 256, ERASE_64K, 20, 50, &M25P, NO_DUAL | NO_QUAD},
+	{0x202017, "M25P64",       8 * MIB, 256, ERASE_64K, 20, 50, &M25P, NO_DUAL | NO_QUAD},
+	{0x202018, "M25P128",     16 * MIB, 256, ERASE_256K, 20, 50, &M25P, NO_DUAL | NO_QUAD},
+	{0x207114, "M25PX80",      1 * MIB, 256, E_4K_64K, 33, 75, &M25P, NO_QUAD},
+	{0x207115, "M25PX16",      2 * MIB, 256, E_4K_64K, 33, 75, &M25P, NO_QUAD},
+	{0x207116, "M25PX32",      4 * MIB, 256, E_4K_64K, 33, 75, &M25P, NO_QUAD},
+	{0x207117, "M25PX64",      8 * MIB, 256, E_4K_64K, 33, 75, &M25P, NO_QUAD},
+	{0x208012, "M25PE20",    256 * KIB, 256, E_4K_64K, 33, 75, &M25P, NO_DUAL | NO_QUAD},
+	{0x208013, "M25PE40",    512 * KIB, 256, E_4K_64K, 33, 75, &M25P, NO_DUAL | NO_QUAD},
+	{0x208014, "M25PE80",      1 * MIB, 256, E_4K_64K, 33, 75, &M25P, NO_DUAL | NO_QUAD},
+	{0x208015, "M25PE16",      2 * MIB, 256, E_4K_64K, 33, 75, &M25P, NO_DUAL | NO_QUAD},
+	{0x20BA16, "N25Q032A",     4 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE},
+	{0x20BA17, "N25Q064A",     8 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE},
+	{0x20BA18, "N25Q128A/MT25QL128",  16 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE},
+	{0x20BA19, "N25Q256A/MT25QL256",  32 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE | ADDR4_ENTER},
+	{0x20BA20, "N25Q512A/MT25QL512",  64 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE | ADDR4_ENTER},
+	{0x20BA21, "N25Q00AA/MT25QL01G", 128 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE | ADDR4_ENTER},
+	{0x20BA22, "MT25QL02G",  256 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE | ADDR4_ENTER},
+	{0x20BB16, "N25Q032A11",   4 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE},
+	{0x20BB17, "N25Q064A11",   8 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE},
+	{0x20BB18, "N25Q128A11/MT25QU128",  16 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE},
+	{0x20BB19, "N25Q256A11/MT25QU256",  32 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE | ADDR4_ENTER},
+	{0x20BB20, "N25Q512A11/MT25QU512",  64 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE | ADDR4_ENTER},
+	{0x20BB21, "N25Q00AA11/MT25QU01G", 128 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE | ADDR4_ENTER},
+	{0x20BB22, "MT25QU02G",  256 * MIB, 256, E_4K_64K, 54, 108, &MICRON, QE_NONE | ADDR4_ENTER},
+
+	//XMC, Winbond compatible
+	{0x204015, "XM25QH16C",    2 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x204016, "XM25QH32C",    4 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x204017, "XM25QH64C",    8 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x204018, "XM25QH128C",  16 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x204019, "XM25QH256C",  32 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1 | ADDR4_ENTER},
+	{0x207016, "XM25QH32A",    4 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x207017, "XM25QH64A",    8 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x207018, "XM25QH128A",  16 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+
+	//Spansion / Cypress / Infineon. QE is CR1 bit 1, written like SR2.
+	//FL-P/S 4 KiB sectors are only in a parameter region, 64 KiB is safe
+	{0x010214, "S25FL016A",    2 * MIB, 256, ERASE_64K, 40, 104, &SPANSION, QE_SR2_BIT1},
+	{0x010215, "S25FL032P",    4 * MIB, 256, ERASE_64K, 40, 104, &SPANSION, QE_SR2_BIT1},
+	{0x010216, "S25FL064P",    8 * MIB, 256, ERASE_64K, 40, 104, &SPANSION, QE_SR2_BIT1},
+	{0x010219, "S25FL256S",   32 * MIB, 256, ERASE_64K, 50, 104, &SPANSION, QE_SR2_BIT1 | ADDR4_OPCODES},
+	{0x010220, "S25FL512S",   64 * MIB, 512, ERASE_256K, 50, 104, &SPANSION, QE_SR2_BIT1 | ADDR4_OPCODES},
+	{0x012018, "S25FL128P/S", 16 * MIB, 256, ERASE_64K, 40, 104, &SPANSION, QE_SR2_BIT1},
+	{0x014015, "S25FL116K",    2 * MIB, 256, E_STD, 50, 104, &SPANSION, QE_SR2_BIT1},
+	{0x014016, "S25FL132K",    4 * MIB, 256, E_STD, 50, 104, &SPANSION, QE_SR2_BIT1},
+	{0x014017, "S25FL164K",    8 * MIB, 256, E_STD, 50, 104, &SPANSION, QE_SR2_BIT1},
+	{0x016017, "S25FL064L",    8 * MIB, 256, E_STD, 50, 104, &SPANSION, QE_SR2_BIT1},
+	{0x016018, "S25FL128L",   16 * MIB, 256, E_STD, 50, 104, &SPANSION, QE_SR2_BIT1},
+	{0x016019, "S25FL256L",   32 * MIB, 256, E_STD, 50, 104, &SPANSION, QE_SR2_BIT1 | ADDR4_OPCODES},
+
+	//SST / Microchip. SST25VF B parts program one byte per command
+	{0xBF2541, "SST25VF016B",  2 * MIB,   1, E_STD, 25, 50, &SST25, NO_DUAL | NO_QUAD | UNLOCK_SR},
+	{0xBF254A, "SST25VF032B",  4 * MIB,   1, E_STD, 25, 50, &SST25, NO_DUAL | NO_QUAD | UNLOCK_SR},
+	{0xBF254B, "SST25VF064C",  8 * MIB, 256, E_STD, 50, 80, &SST25, NO_QUAD | UNLOCK_SR},
+	{0xBF258D, "SST25VF040B", 512 * KIB,  1, E_STD, 25, 50, &SST25, NO_DUAL | NO_QUAD | UNLOCK_SR},
+	{0xBF258E, "SST25VF080B",  1 * MIB,   1, E_STD, 25, 50, &SST25, NO_DUAL | NO_QUAD | UNLOCK_SR},
+	{0xBF2641, "SST26VF016B",  2 * MIB, 256, ERASE_4K, 40, 104, &SST26, NO_QUAD | UNLOCK_ULBPR},
+	{0xBF2642, "SST26VF032B",  4 * MIB, 256, ERASE_4K, 40, 104, &SST26, NO_QUAD | UNLOCK_ULBPR},
+	{0xBF2643, "SST26VF064B",  8 * MIB, 256, ERASE_4K, 40, 104, &SST26, NO_QUAD | UNLOCK_ULBPR},
+
+	//Atmel / Adesto / Renesas
+	{0x1F3217, "AT25SF641",    8 * MIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+	{0x1F4218, "AT25SL128A",  16 * MIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+	{0x1F4216, "AT25SL321",    4 * MIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+	{0x1F4317, "AT25SL641",    8 * MIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+	{0x1F4401, "AT25DF041A", 512 * KIB, 256, E_STD, 33, 70, &ATMEL_DF, NO_QUAD | UNLOCK_SR},
+	{0x1F4501, "AT25DF081A",   1 * MIB, 256, E_STD, 33, 70, &ATMEL_DF, NO_QUAD | UNLOCK_SR},
+	{0x1F4602, "AT25DF161",    2 * MIB, 256, E_STD, 33, 70, &ATMEL_DF, NO_QUAD | UNLOCK_SR},
+	{0x1F4701, "AT25DF321A",   4 * MIB, 256, E_STD, 33, 70, &ATMEL_DF, NO_QUAD | UNLOCK_SR},
+	{0x1F4800, "AT25DF641",    8 * MIB, 256, E_STD, 33, 70, &ATMEL_DF, NO_QUAD | UNLOCK_SR},
+	{0x1F8401, "AT25SF041",  512 * KIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+	{0x1F8501, "AT25SF081",    1 * MIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+	{0x1F8601, "AT25SF161",    2 * MIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+	{0x1F8701, "AT25SF321",    4 * MIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+	{0x1F8901, "AT25SF128A",  16 * MIB, 256, E_STD, 50, 104, &ADESTO_SF, QE_SR2_BIT1},
+
+	//EON / ESMT
+	{0x1C3013, "EN25Q40",    512 * KIB, 256, E_4K_64K, 50, 80, &EON, 0},
+	{0x1C3014, "EN25Q80",      1 * MIB, 256, E_4K_64K, 50, 80, &EON, 0},
+	{0x1C3015, "EN25Q16",      2 * MIB, 256, E_4K_64K, 50, 80, &EON, 0},
+	{0x1C3016, "EN25Q32",      4 * MIB, 256, E_4K_64K, 50, 80, &EON, 0},
+	{0x1C3017, "EN25Q64",      8 * MIB, 256, E_4K_64K, 50, 80, &EON, 0},
+	{0x1C3018, "EN25Q128",    16 * MIB, 256, E_4K_64K, 50, 80, &EON, 0},
+	{0x1C3114, "EN25F80",      1 * MIB, 256, E_4K_64K, 33, 75, &EON, NO_QUAD},
+	{0x1C3115, "EN25F16",      2 * MIB, 256, E_4K_64K, 33, 75, &EON, NO_QUAD},
+	{0x1C3116, "EN25F32",      4 * MIB, 256, E_4K_64K, 33, 75, &EON, NO_QUAD},
+	{0x1C3117, "EN25F64",      8 * MIB, 256, E_4K_64K, 33, 75, &EON, NO_QUAD},
+	{0x1C7014, "EN25QH80",     1 * MIB, 256, E_STD, 50, 104, &EON, 0},
+	{0x1C7015, "EN25QH16",     2 * MIB, 256, E_STD, 50, 104, &EON, 0},
+	{0x1C7016, "EN25QH32",     4 * MIB, 256, E_STD, 50, 104, &EON, 0},
+	{0x1C7017, "EN25QH64",     8 * MIB, 256, E_STD, 50, 104, &EON, 0},
+	{0x1C7018, "EN25QH128",   16 * MIB, 256, E_STD, 50, 104, &EON, 0},
+	{0x1C7019, "EN25QH256",   32 * MIB, 256, E_STD, 50, 104, &EON, ADDR4_ENTER},
+
+	//Puya, Boya, XTX, Fudan, Zbit, Paragon: Winbond compatible clones
+	{0x856011, "P25Q10H",    128 * KIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x856012, "P25Q20H",    256 * KIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x856013, "P25Q40H",    512 * KIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x856014, "P25Q80H",      1 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x856015, "P25Q16H",      2 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x856016, "P25Q32H",      4 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x856017, "P25Q64H",      8 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x856018, "P25Q128H",    16 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x684013, "BY25Q40",    512 * KIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x684014, "BY25Q80",      1 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x684015, "BY25Q16",      2 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x684016, "BY25Q32",      4 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x684017, "BY25Q64",      8 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x684018, "BY25Q128",    16 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x0B4014, "XT25F08B",     1 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x0B4015, "XT25F16B",     2 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x0B4016, "XT25F32B",     4 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x0B4017, "XT25F64B",     8 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x0B4018, "XT25F128B",   16 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0xA14015, "FM25Q16",      2 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0xA14016, "FM25Q32",      4 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0xA14017, "FM25Q64",      8 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0xA14018, "FM25Q128",    16 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x5E4015, "ZB25VQ16",     2 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x5E4016, "ZB25VQ32",     4 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x5E4017, "ZB25VQ64",     8 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0x5E4018, "ZB25VQ128",   16 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, QE_SR2_BIT1},
+	{0xE04013, "PN25F04",    512 * KIB, 256, E_STD, 50, 104, &GENERIC_TIMING, 0},
+	{0xE04014, "PN25F08",      1 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, 0},
+	{0xE04015, "PN25F16",      2 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, 0},
+	{0xE04016, "PN25F32",      4 * MIB, 256, E_STD, 50, 104, &GENERIC_TIMING, 0},
+
+	//AMIC
+	{0x373013, "A25L040",    512 * KIB, 256, E_4K_64K, 33, 75, &GENERIC_TIMING, NO_QUAD},
+	{0x373014, "A25L080",      1 * MIB, 256, E_4K_64K, 33, 75, &GENERIC_TIMING, NO_QUAD},
+	{0x373015, "A25L016",      2 * MIB, 256, E_4K_64K, 33, 75, &GENERIC_TIMING, NO_QUAD},
+	{0x373016, "A25L032",      4 * MIB, 256, E_4K_64K, 33, 75, &GENERIC_TIMING, NO_QUAD},
+};
+
+static const size_t COUNT = sizeof(LIST) / sizeof(LIST[0]);
+
+//Insertion sort by ID, run by the compiler
+static constexpr std::array<Chip, COUNT> sortById(const Chip (&list)[COUNT]) {
+	std::array<Chip, COUNT> chips{};
+	for(size_t i = 0; i < COUNT; i++) {
+		Chip key = list[i];
+		size_t j = i;
+		while(j > 0 && chips[j - 1].id > key.id) {
+			chips[j] = chips[j - 1];
+			j--;
+		}
+		chips[j] = key;
+	}
+	return chips;
+}
+
+static constexpr bool uniqueIds(const std::array<Chip, COUNT> &chips) {
+	for(size_t i = 1; i < COUNT; i++) {
+		if(chips[i - 1].id == chips[i].id) return false;
+	}
+	return true;
+}
+
+static constexpr std::array<Chip, COUNT> CHIPS = sortById(LIST);
+static_assert(uniqueIds(CHIPS), "Chip database has a duplicate JEDEC ID");
+
+/*** Lookup *******************************************************************/
+const Chip *find(unsigned char manufacturer, unsigned char memoryType,
+                 unsigned char capacity) {
+	const uint32_t id = (static_cast<uint32_t>(manufacturer) << 16) |
+	                    (static_cast<uint32_t>(memoryType) << 8) | capacity;
+	auto it = std::lower_bound(CHIPS.begin(), CHIPS.end(), id,
+	                           [](const Chip &chip, uint32_t key) { return chip.id < key; });
+	if(it == CHIPS.end() || it->id != id) return nullptr;
+	return &*it;
+}
+
+size_t count() {
+	return COUNT;
+}
+
+} //namespace ChipDb
@@ -0,0 +1,39 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "crc32.hpp"
+
+//Byte-at-a-time table for the reflected polynomial, built by the compiler
+struct CrcTable {
+	uint32_t entry[256];
+};
+
+static constexpr CrcTable buildTable() {
+	CrcTable table{};
+	for(uint32_t i = 0; i < 256; i++) {
+		uint32_t c = i;
+		for(unsigned int k = 0; k < 8; k++) {
+			c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+		}
+		table.entry[i] = c;
+	}
+	return table;
+}
+
+static constexpr CrcTable CRC_TABLE = buildTable();
+
+void Crc32::update(const unsigned char *data, size_t n) {
+	uint32_t c = crc;
+	for(size_t i = 0; i < n; i++) {
+		c = CRC_TABLE.entry[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+	}
+	crc = c;
+}
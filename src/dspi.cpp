@@ -0,0 +1,45 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "hardware.hpp"
+
+/*** Dual SPI Interface *******************************************************/
+hwDSPI::hwDSPI(int SCLK, int MOSI, int MISO, int CS, int WP, GpioMem *mem)
+	: hwSPI(SCLK, MOSI, MISO, CS, WP, mem) {
+	//Two bits per clock, the odd bit of each pair on IO1
+	dualLanes = {mask_SCLK, {mask_MOSI, mask_MISO, 0, 0},
+	             {static_cast<uint8_t>(MOSI), static_cast<uint8_t>(MISO), 0, 0}};
+}
+
+void hwDSPI::setIoDir(IoDir dir) {
+	if(dir == ioDir) return;
+	
+	pinMode(io_MOSI, dir != IoDir::IN);
+	pinMode(io_MISO, dir == IoDir::OUT);
+	ioDir = dir;
+}
+
+void hwDSPI::stop() {
+	hwSPI::stop();
+	setIoDir(IoDir::SINGLE);
+}
+
+const Kernel::Lanes &hwDSPI::prepareLanes(unsigned int lanes, bool output) {
+	if(lanes != 2) {
+		setIoDir(IoDir::SINGLE);
+		return hwSPI::prepareLanes(lanes, output);
+	}
+	
+	//Released before the first data clock, the chip drives both lines from
+	//the falling edge after the address or dummy phase
+	setIoDir(output ? IoDir::OUT : IoDir::IN);
+	return dualLanes;
+}
@@ -0,0 +1,67 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <algorithm>
+
+#include "eraseplan.hpp"
+
+namespace ErasePlan {
+
+Plan plan(const std::vector<Type> &types, uint64_t from, uint64_t to) {
+	Plan result;
+	if(types.empty() || to <= from) return result;
+
+	uint32_t unit = types[0].bytes;
+	for(const Type &t : types) unit = std::min(unit, t.bytes);
+	result.start = from - from % unit;
+	result.end = (to + unit - 1) / unit * unit;
+
+	//Shortest path over the unit boundaries: time[i] is the least typical
+	//time to erase up to start + i units, via[i] the type that got there
+	const size_t units = static_cast<size_t>((result.end - result.start) / unit);
+	const uint64_t NONE = UINT64_MAX;
+	std::vector<uint64_t> time(units + 1, NONE);
+	std::vector<size_t> via(units + 1, 0);
+	time[0] = 0;
+	for(size_t i = 0; i < units; i++) {
+		if(time[i] == NONE) continue;
+		const uint64_t addr = result.start + uint64_t(i) * unit;
+		for(size_t t = 0; t < types.size(); t++) {
+			const Type &type = types[t];
+			const size_t span = type.bytes / unit;
+			if(addr % type.bytes != 0 || i + span > units) continue;
+			//A zero time would make every mix look free
+			const uint64_t cost = time[i] + std::max<uint32_t>(type.typMs, 1);
+			if(cost < time[i + span]) {
+				time[i + span] = cost;
+				via[i + span] = t;
+			}
+		}
+	}
+
+	//Walk back from the end, then put the steps in address order
+	for(size_t i = units; i > 0; ) {
+		const Type &type = types[via[i]];
+		i -= type.bytes / unit;
+		result.steps.push_back(Step{result.start + uint64_t(i) * unit, type.bytes, type.cmd});
+	}
+	std::reverse(result.steps.begin(), result.steps.end());
+	result.typMs = time[units];
+	return result;
+}
+
+uint32_t typicalMs(const ChipDb::Timing &timing, uint32_t bytes) {
+	if(bytes <= 4096) return timing.seTypMs;
+	if(bytes <= 32768) return (timing.seTypMs + timing.beTypMs) / 2;
+	return timing.beTypMs * std::max<uint32_t>(1, bytes / 65536);
+}
+
+} //namespace ErasePlan
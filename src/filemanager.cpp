@@ -16,7 +16,7 @@
 #include "filemanager.hpp"
 
 //Constructor: Input Filename. Opens the file ready for read or write
-BinFile::BinFile(const char *inptFN, const char mode) {
+BinFile::BinFile(const char *inptFN, const char mode, const size_t arrayBytes) {
 	//Create a char array at filename the size of the input string.
 	this->filename = new char[ strlen(inptFN) + 1 ];
 	//Copy the input string to the new char array at filename
@@ -40,8 +40,9 @@ BinFile::BinFile(const char *inptFN, const char mode) {
 		exit(EXIT_FAILURE);
 	}
 	
-	//Create the RAM Byte array, of size defined in header
-	byteArrayPtr = new char[MAX_RAM_BYTES];
+	//Create the RAM Byte array, MAX_RAM_BYTES unless asked otherwise
+	byteArraySize = static_cast<unsigned int>(arrayBytes);
+	byteArrayPtr = new char[byteArraySize];
 }
 
 BinFile::~BinFile() {
@@ -57,8 +58,8 @@ std::string BinFile::getFilename() {
 }
 
 void BinFile::pushByteToArray(const char byte) {
-	//Check if the current byte pos equals the MAX_RAM_BYTES
-	if(byteArrayPos == MAX_RAM_BYTES) {
+	//Check if the current byte pos equals the array size
+	if(byteArrayPos == byteArraySize) {
 		//Flush the array to the file
 		flushArrayToFile();
 	}
@@ -70,6 +71,23 @@ void BinFile::pushByteToArray(const char byte) {
 	++byteArrayPos;
 }
 
+void BinFile::pushBytesToArray(const char *bytes, const size_t count) {
+	size_t remaining = count;
+	while(remaining > 0) {
+		//Flush the array when full, same as pushByteToArray
+		if(byteArrayPos == byteArraySize) flushArrayToFile();
+		
+		//Copy as much as fits in the array in one go
+		size_t space = byteArraySize - byteArrayPos;
+		size_t chunk = remaining < space ? remaining : space;
+		memcpy(byteArrayPtr + byteArrayPos, bytes, chunk);
+		
+		byteArrayPos += chunk;
+		bytes += chunk;
+		remaining -= chunk;
+	}
+}
+
 int BinFile::flushArrayToFile() {
 	if (byteArrayPos == 0) return 0;
 	file.write(byteArrayPtr, byteArrayPos);
@@ -77,10 +95,19 @@ int BinFile::flushArrayToFile() {
 	return 0;
 }
 
+void BinFile::prefault() {
+	memset(byteArrayPtr, 0, byteArraySize);
+}
+
+void BinFile::seekWrite(const uint64_t pos) {
+	flushArrayToFile();
+	file.seekp(static_cast<std::streamoff>(pos));
+}
+
 bool BinFile::pullByteFromFile(char &byte) {
 	if (!readMode) return false;
 	if (byteArrayPos >= byteArrayLen) {
-		file.read(byteArrayPtr, MAX_RAM_BYTES);
+		file.read(byteArrayPtr, byteArraySize);
 		byteArrayLen = static_cast<unsigned int>(file.gcount());
 		byteArrayPos = 0;
 		if (byteArrayLen == 0) return false;
@@ -88,3 +115,31 @@ bool BinFile::pullByteFromFile(char &byte) {
 	byte = byteArrayPtr[byteArrayPos++];
 	return true;
 }
+
+size_t BinFile::pullBytesFromFile(char *bytes, const size_t count) {
+	if (!readMode) return 0;
+	size_t done = 0;
+	while (done < count) {
+		//Refill the array from the file when it has been used up
+		if (byteArrayPos >= byteArrayLen) {
+			file.read(byteArrayPtr, byteArraySize);
+			byteArrayLen = static_cast<unsigned int>(file.gcount());
+			byteArrayPos = 0;
+			if (byteArrayLen == 0) break;
+		}
+		size_t avail = byteArrayLen - byteArrayPos;
+		size_t chunk = (count - done) < avail ? (count - done) : avail;
+		memcpy(bytes + done, byteArrayPtr + byteArrayPos, chunk);
+		byteArrayPos += chunk;
+		done += chunk;
+	}
+	return done;
+}
+
+void BinFile::seekRead(const uint64_t pos) {
+	if (!readMode) return;
+	file.clear();
+	file.seekg(static_cast<std::streamoff>(pos));
+	byteArrayPos = 0;
+	byteArrayLen = 0;
+}
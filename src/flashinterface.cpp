@@ -0,0 +1,134 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "hardware.hpp"
+
+#include <iostream>
+#include <cstring>
+
+//The parts of FlashInterface shared by every interface, kept apart from the
+//pigpio based ones so they build and test without pigpio
+
+/*** Default bulk transfer ****************************************************/
+void FlashInterface::transfer(const unsigned char *tx, unsigned char *rx,
+                              size_t n) {
+	for(size_t i = 0; i < n; i++) {
+		if(tx != nullptr) writeByte(static_cast<char>(tx[i]));
+		if(rx != nullptr) rx[i] = static_cast<unsigned char>(readByte());
+	}
+}
+
+bool FlashInterface::dummy(unsigned int cycles) {
+	if(cycles % 8 != 0) {
+		std::cerr << "Error: Interface can only clock whole bytes, " << cycles
+		          << " dummy cycles requested" << std::endl;
+		return false;
+	}
+	
+	//The data sent is don't care, the byte writes are just clocks
+	for(unsigned int i = 0; i < cycles / 8; i++) writeByte(0);
+	return true;
+}
+
+/*** Read command *************************************************************/
+bool FlashInterface::beginRead(const ReadOp &op, uint64_t addr, bool sendCmd) {
+	if(op.addrLanes > maxLanes() || op.dataLanes > maxLanes()) {
+		std::cerr << "Error: Read command 0x" << std::hex << (int)op.cmd << std::dec
+		          << " needs " << op.dataLanes << " data lines, the interface has "
+		          << maxLanes() << std::endl;
+		return false;
+	}
+	
+	if(op.dtr && !dtrCapable()) {
+		std::cerr << "Error: Read command 0x" << std::hex << (int)op.cmd << std::dec
+		          << " is DTR, the interface cannot clock data on both edges"
+		          << std::endl;
+		return false;
+	}
+	
+	//The address most significant byte first, after the command byte
+	unsigned char seq[5] = {op.cmd};
+	for(unsigned int i = 0; i < op.addrBytes; i++) {
+		seq[1 + i] = static_cast<unsigned char>((addr >> (8 * (op.addrBytes - 1 - i))) & 0xFF);
+	}
+	const unsigned char *addrBytes = seq + 1;
+	const unsigned char mode = static_cast<unsigned char>(op.mode);
+	
+	//The command byte is always single edge, everything after it is DTR
+	if(op.dtr) {
+		if(sendCmd) write(&op.cmd, 1);
+		writeDtr(addrBytes, op.addrBytes, op.addrLanes);
+		if(op.mode >= 0) writeDtr(&mode, 1, op.addrLanes);
+		return op.dummyCycles == 0 || dummy(op.dummyCycles);
+	}
+	
+	if(op.addrLanes == 1 && sendCmd) {
+		write(seq, 1 + op.addrBytes);
+	} else {
+		if(sendCmd) write(&op.cmd, 1);
+		writeWide(addrBytes, op.addrBytes, op.addrLanes);
+	}
+	
+	if(op.mode >= 0) writeWide(&mode, 1, op.addrLanes);
+	
+	return op.dummyCycles == 0 || dummy(op.dummyCycles);
+}
+
+/*** Random reads *************************************************************/
+bool FlashInterface::readAt(const ReadOp &op, uint64_t addr, unsigned char *buf,
+                            size_t n) {
+	//Another command, or another address width, needs a fresh start
+	if(continuous && (op.cmd != continuousOp.cmd ||
+	                  op.addrBytes != continuousOp.addrBytes)) {
+		endRandomRead();
+	}
+	
+	ReadOp send = op;
+	if(op.mode >= 0) send.mode = Limits::S25_XIP_MODE;
+	
+	start();
+	if(!beginRead(send, addr, !continuous)) {
+		stop();
+		return false;
+	}
+	if(op.dtr) {
+		readDtr(buf, n, op.dataLanes);
+	} else {
+		readWide(buf, n, op.dataLanes);
+	}
+	stop();
+	
+	if(op.mode >= 0 && !continuous) {
+		continuous = true;
+		continuousOp = op;
+	}
+	return !failed();
+}
+
+void FlashInterface::endRandomRead() {
+	if(!continuous) return;
+	
+	//The chip takes the next CS cycle as address and mode byte. All ones
+	//makes the mode byte 0xFF, which ends continuous read on every vendor,
+	//and raising CS before the dummy clocks drops the read
+	unsigned char ones[5];
+	memset(ones, 0xFF, sizeof(ones));
+	const size_t n = continuousOp.addrBytes + 1;
+	start();
+	if(continuousOp.dtr) {
+		writeDtr(ones, n, continuousOp.addrLanes);
+	} else {
+		writeWide(ones, n, continuousOp.addrLanes);
+	}
+	stop();
+	
+	continuous = false;
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "gather.hpp"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define GATHER_NEON
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define GATHER_X86
+#endif
+
+namespace Gather {
+
+void packBitsScalar(const uint32_t *levels, size_t count, unsigned int pin,
+                    unsigned char *out) {
+	for(size_t i = 0; i + 8 <= count; i += 8) {
+		unsigned int acc = 0;
+		for(unsigned int k = 0; k < 8; k++) {
+			acc = (acc << 1) | ((levels[i + k] >> pin) & 1u);
+		}
+		*out++ = static_cast<unsigned char>(acc);
+	}
+}
+
+#if defined(GATHER_NEON)
+//Isolate the bit in each lane, weight the lanes 8,4,2,1 and add them up
+static void packBitsNeon(const uint32_t *levels, size_t count, unsigned int pin,
+                         unsigned char *out) {
+	const int32x4_t shift = vdupq_n_s32(-static_cast<int32_t>(pin));
+	const uint32x4_t one = vdupq_n_u32(1);
+	static const uint32_t weightVals[4] = {8, 4, 2, 1};
+	const uint32x4_t weights = vld1q_u32(weightVals);
+
+	for(size_t i = 0; i + 8 <= count; i += 8) {
+		uint32x4_t hi = vandq_u32(vshlq_u32(vld1q_u32(levels + i), shift), one);
+		uint32x4_t lo = vandq_u32(vshlq_u32(vld1q_u32(levels + i + 4), shift), one);
+
+		//hi lanes carry 128..16, lo lanes 8..1
+		uint32x4_t sum = vaddq_u32(vshlq_n_u32(vmulq_u32(hi, weights), 4),
+		                           vmulq_u32(lo, weights));
+		uint32x2_t pair = vadd_u32(vget_low_u32(sum), vget_high_u32(sum));
+		pair = vpadd_u32(pair, pair);
+		*out++ = static_cast<unsigned char>(vget_lane_u32(pair, 0));
+	}
+}
+#endif
+
+#if defined(GATHER_X86)
+//Move the bit to the sign position and let movemask collect it. The lanes are
+//reversed first, movemask puts lane 0 in bit 0 but the first snapshot is the MSB
+static void packBitsSse2(const uint32_t *levels, size_t count, unsigned int pin,
+                         unsigned char *out) {
+	const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(31 - pin));
+
+	for(size_t i = 0; i + 8 <= count; i += 8) {
+		__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(levels + i));
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(levels + i + 4));
+		hi = _mm_shuffle_epi32(_mm_sll_epi32(hi, shift), _MM_SHUFFLE(0, 1, 2, 3));
+		lo = _mm_shuffle_epi32(_mm_sll_epi32(lo, shift), _MM_SHUFFLE(0, 1, 2, 3));
+
+		int bits = (_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4) |
+		           _mm_movemask_ps(_mm_castsi128_ps(lo));
+		*out++ = static_cast<unsigned char>(bits);
+	}
+}
+
+__attribute__((target("avx2")))
+static void packBitsAvx2(const uint32_t *levels, size_t count, unsigned int pin,
+                         unsigned char *out) {
+	const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(31 - pin));
+	const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+	for(size_t i = 0; i + 8 <= count; i += 8) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(levels + i));
+		v = _mm256_permutevar8x32_epi32(_mm256_sll_epi32(v, shift), reverse);
+		*out++ = static_cast<unsigned char>(
+			_mm256_movemask_ps(_mm256_castsi256_ps(v)));
+	}
+}
+
+static bool haveAvx2() {
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	return avx2;
+}
+#endif
+
+void packBits(const uint32_t *levels, size_t count, unsigned int pin,
+              unsigned char *out) {
+	#if defined(GATHER_NEON)
+	packBitsNeon(levels, count, pin, out);
+	#elif defined(GATHER_X86)
+	if(haveAvx2()) {
+		packBitsAvx2(levels, count, pin, out);
+	} else {
+		packBitsSse2(levels, count, pin, out);
+	}
+	#else
+	packBitsScalar(levels, count, pin, out);
+	#endif
+}
+
+void packBitsMulti(const uint32_t *levels, size_t count,
+                   const unsigned int *pins, size_t pinCount,
+                   unsigned char *const *out) {
+	for(size_t i = 0; i < pinCount; i++) {
+		packBits(levels, count, pins[i], out[i]);
+	}
+}
+
+const char *implName() {
+	#if defined(GATHER_NEON)
+	return "NEON";
+	#elif defined(GATHER_X86)
+	return haveAvx2() ? "AVX2" : "SSE2";
+	#else
+	return "scalar";
+	#endif
+}
+
+} //namespace Gather
@@ -0,0 +1,75 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "gpiomem.hpp"
+
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+GpioMem::~GpioMem() {
+	close();
+}
+
+bool GpioMem::open(const char *path) {
+	close();
+
+	int fd = ::open(path, O_RDWR | O_SYNC);
+	if(fd < 0) {
+		std::cerr << "Error: Cannot open " << path << ": "
+		          << strerror(errno) << std::endl;
+		return false;
+	}
+
+	void *map = mmap(nullptr, GpioReg::BLOCK_SIZE, PROT_READ | PROT_WRITE,
+	                 MAP_SHARED, fd, 0);
+	//The mapping stays valid after the descriptor is closed
+	::close(fd);
+
+	if(map == MAP_FAILED) {
+		std::cerr << "Error: Cannot map GPIO registers from " << path << ": "
+		          << strerror(errno) << std::endl;
+		return false;
+	}
+
+	regs = static_cast<volatile uint32_t *>(map);
+	owned = true;
+	return true;
+}
+
+void GpioMem::attach(volatile uint32_t *base) {
+	close();
+	regs = base;
+	owned = false;
+}
+
+void GpioMem::close() {
+	if(regs != nullptr && owned) {
+		munmap(const_cast<uint32_t *>(regs), GpioReg::BLOCK_SIZE);
+	}
+	regs = nullptr;
+	owned = false;
+}
+
+void GpioMem::setMode(const unsigned int pin, const unsigned int mode) {
+	//Each GPFSEL word holds 3 bits for each of 10 pins
+	volatile uint32_t *fsel = regs + GpioReg::GPFSEL0 + (pin / 10);
+	unsigned int shift = (pin % 10) * 3;
+
+	uint32_t val = *fsel;
+	val &= ~(7u << shift);
+	val |= (mode & 7u) << shift;
+	*fsel = val;
+}
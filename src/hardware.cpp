@@ -10,13 +10,48 @@
 * (c) ADBeta
 *******************************************************************************/
 #include "hardware.hpp"
+#include "timing.hpp"
+#include "kernels.hpp"
+#include "gather.hpp"
+#include "crc32.hpp"
+#include "realtime.hpp"
+#include "ranges.hpp"
+#include "eraseplan.hpp"
+#include "blank.hpp"
+#include "manifest.hpp"
 
+#include <algorithm>
+#include <csignal>
 #include <iostream>
+#include <iomanip>
+#include <sstream>
 #include <string>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
 #include <pigpio.h>
 
+/*** pigpio Port policy ******************************************************/
+//Drives bank 0 through pigpio, one library call per store. A zero mask is
+//skipped as it would cost a call for nothing
+struct PigpioPort {
+	void set(uint32_t mask) { if(mask != 0) gpioWrite_Bits_0_31_Set(mask); }
+	void clr(uint32_t mask) { if(mask != 0) gpioWrite_Bits_0_31_Clear(mask); }
+	void write(uint32_t setMask, uint32_t clrMask) {
+		set(setMask);
+		clr(clrMask);
+	}
+	uint32_t lev() { return gpioRead_Bits_0_31(); }
+};
+
+//Transmit table for the default pinout, built by the compiler
+static constexpr MaskTable::Table DEFAULT_TX_TABLE =
+	MaskTable::build(1u << Pinout::SPI_MOSI, 1u << Pinout::SPI_SCLK);
+
 /*** Hardware SPI Interface ***************************************************/
-hwSPI::hwSPI(int SCLK, int MOSI, int MISO, int CS, int WP) {
+hwSPI::hwSPI(int SCLK, int MOSI, int MISO, int CS, int WP, GpioMem *mem) {
 	//Set the object pins to the passed pins
 	io_SCLK = SCLK;
 	io_MOSI = MOSI;
@@ -24,26 +59,60 @@ hwSPI::hwSPI(int SCLK, int MOSI, int MISO, int CS, int WP) {
 	io_CS = CS;
 	io_WP = WP;
 	
+	//Register driver and the pin masks it uses in the bit loops
+	gpio = mem;
+	mask_SCLK = 1u << SCLK;
+	mask_MOSI = 1u << MOSI;
+	mask_MISO = 1u << MISO;
+	
+	//Transmit table, built at runtime only for a non-default pinout
+	if(SCLK == Pinout::SPI_SCLK && MOSI == Pinout::SPI_MOSI) {
+		txTable = &DEFAULT_TX_TABLE;
+	} else {
+		ownTable.reset(new MaskTable::Table(MaskTable::build(mask_MOSI, mask_SCLK)));
+		txTable = ownTable.get();
+	}
+	
+	levelBuf.resize(Limits::CAPTURE_BYTES * 8);
+	singleLanes = {mask_SCLK, {mask_MOSI, 0, 0, 0},
+	               {static_cast<uint8_t>(MISO), 0, 0, 0}};
+	
 	//Set the GPIO pinout to idle the interface
 	init();
 	
 }
 
+void hwSPI::pinMode(int pin, bool output) {
+	if(gpio != nullptr) {
+		gpio->setMode(pin, output ? GpioReg::FSEL_OUTPUT : GpioReg::FSEL_INPUT);
+	} else {
+		gpioSetMode(pin, output ? PI_OUTPUT : PI_INPUT);
+	}
+}
+
+void hwSPI::pinWrite(int pin, unsigned int level) {
+	if(gpio != nullptr) {
+		gpio->write(pin, level);
+	} else {
+		gpioWrite(pin, level);
+	}
+}
+
 void hwSPI::init() {
 	//Set the output pins
-	gpioSetMode(io_SCLK, PI_OUTPUT);
-	gpioSetMode(io_MOSI, PI_OUTPUT);
-	gpioSetMode(io_CS, PI_OUTPUT);
-	gpioSetMode(io_WP, PI_OUTPUT);
+	pinMode(io_SCLK, true);
+	pinMode(io_MOSI, true);
+	pinMode(io_CS, true);
+	pinMode(io_WP, true);
 	
 	//MISO is an input (Master In)
-	gpioSetMode(io_MISO, PI_INPUT);
+	pinMode(io_MISO, false);
 	
 	//Set MOSI and SCLK low to idle
-	gpioWrite(io_SCLK, 0);
-	gpioWrite(io_MOSI, 0);
+	pinWrite(io_SCLK, 0);
+	pinWrite(io_MOSI, 0);
 	//MISO LOW to pulldown
-	gpioWrite(io_MISO, 0);
+	pinWrite(io_MISO, 0);
 	
 	stop(); //Pulls the CS pin high and waits
 	
@@ -52,79 +121,293 @@ void hwSPI::init() {
 }
 
 void hwSPI::setWriteProtect(bool enable) {
-	gpioWrite(io_WP, enable ? 1 : 0);
+	wpLevel = enable;
+	pinWrite(io_WP, enable ? 1 : 0);
 }
 
 void hwSPI::setTiming(unsigned int KHz) {
-	// pigpio minimum delay is 1 us; 0 = no delay (max speed). Half-period in us = 500/KHz.
-	if (KHz == 0) {
-		wait_clk = 0;
-		wait_bit = 0;
-		wait_byte = 0;
-	} else {
-		unsigned int halfUs = 500 / KHz;
-		if (halfUs < 1) halfUs = 1;
-		wait_clk = halfUs;
-		wait_bit = halfUs;
-		wait_byte = halfUs;
+	//0 = no delay (max speed)
+	wait_clk = Timing::Wait();
+	wait_bit = Timing::Wait();
+	wait_cs  = Timing::Wait();
+	
+	if (KHz != 0) {
+		//Each edge costs driver time of its own. Measure it with no waits and
+		//take it off the half period so the clock lands on the requested rate
+		uint32_t halfNs = 500000u / KHz;
+		uint32_t edgeNs = static_cast<uint32_t>(measureHalfNs());
+		uint32_t spinNs = (halfNs > edgeNs) ? halfNs - edgeNs : 0;
+		
+		wait_bit = Timing::makeWait(spinNs);
+		wait_clk = Timing::makeWait(spinNs);
+		wait_cs  = Timing::makeWait(halfNs);
+	}
+	
+	//Report what the interface really reaches with these waits
+	achieved = static_cast<unsigned int>(500000.0 / measureHalfNs());
+	if (KHz != 0 && achieved < (KHz * 9) / 10) {
+		std::cerr << "Warning: Requested " << KHz << "KHz, but the interface "
+		          << "only reaches " << achieved << "KHz" << std::endl;
 	}
 }
 
+double hwSPI::measureHalfNs() {
+	//Clock 512 cycles with CS high, the flash ignores them
+	const unsigned int bytes = 64;
+	
+	uint64_t start = Timing::nowNs();
+	for(unsigned int i = 0; i < bytes; i++) rx_byte();
+	uint64_t took = Timing::nowNs() - start;
+	
+	double halfNs = static_cast<double>(took) / (bytes * 8 * 2);
+	return halfNs > 1.0 ? halfNs : 1.0;
+}
+
 void hwSPI::tx_byte(const char byte) {
-	//TX Bits, data clocked in on the rising edge of CLK, MSBFirst
-	for(signed char bitIndex = 7; bitIndex >= 0; bitIndex--) {
-		//Write the current bit (input byte shifted x to the right, AND 0x01)
-		gpioWrite(io_MOSI, (byte >> bitIndex) & 0x01);
-		//Wait for the bit delay
-		if(wait_bit != 0) gpioDelay(wait_bit);
-		
-		
-		gpioWrite(io_SCLK, 1);                    //Set the clock pin HIGH
-		if(wait_clk != 0) gpioDelay(wait_clk); //Delay if selected
-		gpioWrite(io_SCLK, 0);                    //Set the clock pin LOW
-		if(wait_clk != 0) gpioDelay(wait_clk); //Delay if selected
+	const unsigned char out = static_cast<unsigned char>(byte);
+	bitbang(&out, nullptr, 1);
+}
+
+char hwSPI::rx_byte(void) {
+	unsigned char data = 0;
+	bitbang(nullptr, &data, 1);
+	return static_cast<char>(data);
+}
+
+char hwSPI::xfer_byte(const char byte) {
+	const unsigned char out = static_cast<unsigned char>(byte);
+	unsigned char data = 0;
+	bitbang(&out, &data, 1);
+	return static_cast<char>(data);
+}
+
+void hwSPI::start() {
+	pinWrite(io_CS, 0);
+	Timing::delay(wait_cs);
+}
+
+void hwSPI::stop() {
+	pinWrite(io_CS, 1);
+	Timing::delay(wait_cs);
+}
+
+//Per transfer state the single lane kernels need besides the pins
+struct SingleCtx {
+	const MaskTable::Table &table;
+	uint32_t *levels;
+	unsigned int misoPin;
+};
+
+//Run the single lane kernel for this delay. Transmit only goes through the
+//mask table, receive only captures level snapshots a block at a time and
+//decodes each block in one go
+template<class Port, class Delay>
+static void runSingle(Port &port, const Delay &delay, const Kernel::Lanes &lanes,
+                      const SingleCtx &ctx,
+                      const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(tx != nullptr && rx == nullptr) {
+		Kernel::TableKernel<Port, Delay>::tx(port, delay, ctx.table, lanes.sclk, tx, n);
+	} else if(tx == nullptr && rx != nullptr) {
+		while(n > 0) {
+			size_t block = (n > Limits::CAPTURE_BYTES) ? Limits::CAPTURE_BYTES : n;
+			Kernel::BitKernel<Port, Delay, 1>::capture(port, delay, lanes,
+			                                            ctx.levels, block);
+			Gather::packBits(ctx.levels, block * 8, ctx.misoPin, rx);
+			rx += block;
+			n -= block;
+		}
+	} else {
+		Kernel::BitKernel<Port, Delay, 1>::run(port, delay, lanes, tx, rx, n);
 	}
+}
 
-	//Wait for the byte delay if selected
-	if(wait_byte != 0) gpioDelay(wait_byte);	
+//Run the single lane kernel for this port, with or without waits
+template<class Port>
+static void runSingle(Port &port, const Kernel::Lanes &lanes,
+                      const SingleCtx &ctx,
+                      const Timing::Wait &lowWait, const Timing::Wait &highWait,
+                      const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(lowWait.ns == 0 && highWait.ns == 0) {
+		runSingle(port, Kernel::NoDelay(), lanes, ctx, tx, rx, n);
+	} else {
+		Kernel::SpinDelay delay = {lowWait, highWait};
+		runSingle(port, delay, lanes, ctx, tx, rx, n);
+	}
 }
 
-char hwSPI::rx_byte(void) {
-	char data = 0;
+void hwSPI::bitbang(const unsigned char *tx, unsigned char *rx, size_t n) {
+	//Data clocked in on the rising edge of CLK, MSBFirst. MOSI is set up and
+	//MISO sampled during the low half of the clock
+	const Kernel::Lanes &lanes = singleLanes;
+	const SingleCtx ctx = {*txTable, levelBuf.data(),
+	                       static_cast<unsigned int>(io_MISO)};
 	
-	//RX Bits into data, bit present on falling edge, MSBFirst
-	for(unsigned char bitIndex = 0; bitIndex < 8; bitIndex++) {
-		//shift the data byte 1 position to the left
-		data = data << 1;
-		
-		bool cBit = gpioRead(io_MISO);
-		
-		//Set the LSB of data to read from gpio
-		if(cBit != 0) data = data | 0x01;
-		
-		//Wait for the bit delay
-		if(wait_bit != 0) gpioDelay(wait_bit);
-		
-		gpioWrite(io_SCLK, 1);                 //Set the clock pin HIGH
-		if(wait_clk != 0) gpioDelay(wait_clk); //Delay if selected
-		gpioWrite(io_SCLK, 0);                 //Set the clock pin LOW
-		if(wait_clk != 0) gpioDelay(wait_clk); //Delay if selected
+	//Pick the kernel once for the whole transfer
+	if(gpio != nullptr) {
+		Kernel::MemPort port = {*gpio};
+		runSingle(port, lanes, ctx, wait_bit, wait_clk, tx, rx, n);
+	} else {
+		PigpioPort port;
+		runSingle(port, lanes, ctx, wait_bit, wait_clk, tx, rx, n);
 	}
-	
-	//Wait for the byte delay if selected
-	if(wait_byte != 0) gpioDelay(wait_byte);	
-	
-	return data;
 }
 
-void hwSPI::start() {
-	gpioWrite(io_CS, 0);
-	if(wait_byte != 0) gpioDelay(wait_byte);
+void hwSPI::transfer(const unsigned char *tx, unsigned char *rx, size_t n) {
+	bitbang(tx, rx, n);
 }
 
-void hwSPI::stop() {
-	gpioWrite(io_CS, 1);
-	if(wait_byte != 0) gpioDelay(wait_byte);
+//Run the multi lane kernel for this port, with or without waits
+template<class Port, unsigned int LANES>
+static void runLanes(Port &port, const Kernel::Lanes &lanes,
+                     const Timing::Wait &lowWait, const Timing::Wait &highWait,
+                     const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(lowWait.ns == 0 && highWait.ns == 0) {
+		Kernel::BitKernel<Port, Kernel::NoDelay, LANES>::run(
+			port, Kernel::NoDelay(), lanes, tx, rx, n);
+	} else {
+		Kernel::SpinDelay delay = {lowWait, highWait};
+		Kernel::BitKernel<Port, Kernel::SpinDelay, LANES>::run(
+			port, delay, lanes, tx, rx, n);
+	}
+}
+
+template<class Port>
+static void runLanes(Port &port, const Kernel::Lanes &lanes, unsigned int count,
+                     const Timing::Wait &lowWait, const Timing::Wait &highWait,
+                     const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(count == 4) {
+		runLanes<Port, 4>(port, lanes, lowWait, highWait, tx, rx, n);
+	} else {
+		runLanes<Port, 2>(port, lanes, lowWait, highWait, tx, rx, n);
+	}
+}
+
+void hwSPI::bitbangLanes(const Kernel::Lanes &lanes, unsigned int count,
+                         const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(gpio != nullptr) {
+		Kernel::MemPort port = {*gpio};
+		runLanes(port, lanes, count, wait_bit, wait_clk, tx, rx, n);
+	} else {
+		PigpioPort port;
+		runLanes(port, lanes, count, wait_bit, wait_clk, tx, rx, n);
+	}
+}
+
+//Run the DTR kernel for this port and lane count, with or without waits
+template<class Port, unsigned int LANES>
+static void runDtr(Port &port, const Kernel::Lanes &lanes,
+                   const Timing::Wait &lowWait, const Timing::Wait &highWait,
+                   const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(lowWait.ns == 0 && highWait.ns == 0) {
+		Kernel::DtrKernel<Port, Kernel::NoDelay, LANES>::run(
+			port, Kernel::NoDelay(), lanes, tx, rx, n);
+	} else {
+		Kernel::SpinDelay delay = {lowWait, highWait};
+		Kernel::DtrKernel<Port, Kernel::SpinDelay, LANES>::run(
+			port, delay, lanes, tx, rx, n);
+	}
+}
+
+template<class Port>
+static void runDtr(Port &port, const Kernel::Lanes &lanes, unsigned int count,
+                   const Timing::Wait &lowWait, const Timing::Wait &highWait,
+                   const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(count == 4) {
+		runDtr<Port, 4>(port, lanes, lowWait, highWait, tx, rx, n);
+	} else if(count == 2) {
+		runDtr<Port, 2>(port, lanes, lowWait, highWait, tx, rx, n);
+	} else {
+		runDtr<Port, 1>(port, lanes, lowWait, highWait, tx, rx, n);
+	}
+}
+
+void hwSPI::bitbangDtr(const Kernel::Lanes &lanes, unsigned int count,
+                       const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(gpio != nullptr) {
+		Kernel::MemPort port = {*gpio};
+		runDtr(port, lanes, count, wait_bit, wait_clk, tx, rx, n);
+	} else {
+		PigpioPort port;
+		runDtr(port, lanes, count, wait_bit, wait_clk, tx, rx, n);
+	}
+}
+
+const Kernel::Lanes &hwSPI::prepareLanes(unsigned int lanes, bool output) {
+	(void)lanes;
+	(void)output;
+	return singleLanes;
+}
+
+void hwSPI::writeWide(const unsigned char *buf, size_t n, unsigned int lanes) {
+	const Kernel::Lanes &kl = prepareLanes(lanes, true);
+	if(lanes == 1) {
+		write(buf, n);
+	} else {
+		bitbangLanes(kl, lanes, buf, nullptr, n);
+	}
+}
+
+void hwSPI::readWide(unsigned char *buf, size_t n, unsigned int lanes) {
+	const Kernel::Lanes &kl = prepareLanes(lanes, false);
+	if(lanes == 1) {
+		read(buf, n);
+	} else {
+		bitbangLanes(kl, lanes, nullptr, buf, n);
+	}
+}
+
+void hwSPI::writeDtr(const unsigned char *buf, size_t n, unsigned int lanes) {
+	bitbangDtr(prepareLanes(lanes, true), lanes, buf, nullptr, n);
+}
+
+void hwSPI::readDtr(unsigned char *buf, size_t n, unsigned int lanes) {
+	bitbangDtr(prepareLanes(lanes, false), lanes, nullptr, buf, n);
+}
+
+//Capture n bytes worth of level snapshots for this port, with or without waits
+template<class Port>
+static void captureSingle(Port &port, const Kernel::Lanes &lanes,
+                          const Timing::Wait &lowWait, const Timing::Wait &highWait,
+                          uint32_t *levels, size_t n) {
+	if(lowWait.ns == 0 && highWait.ns == 0) {
+		Kernel::BitKernel<Port, Kernel::NoDelay, 1>::capture(
+			port, Kernel::NoDelay(), lanes, levels, n);
+	} else {
+		Kernel::SpinDelay delay = {lowWait, highWait};
+		Kernel::BitKernel<Port, Kernel::SpinDelay, 1>::capture(
+			port, delay, lanes, levels, n);
+	}
+}
+
+void hwSPI::setMisoPins(const std::vector<int> &pins) {
+	multiMiso.clear();
+	for(int pin : pins) {
+		pinMode(pin, false);
+		multiMiso.push_back(static_cast<unsigned int>(pin));
+	}
+}
+
+void hwSPI::readMulti(unsigned char *const *outs, size_t n) {
+	//Every snapshot holds one bit from each chip, MOSI is not driven
+	const Kernel::Lanes lanes = {mask_SCLK, {0, 0, 0, 0}, {0, 0, 0, 0}};
+	std::vector<unsigned char *> dst(outs, outs + multiMiso.size());
+	
+	while(n > 0) {
+		size_t block = (n > Limits::CAPTURE_BYTES) ? Limits::CAPTURE_BYTES : n;
+		
+		if(gpio != nullptr) {
+			Kernel::MemPort port = {*gpio};
+			captureSingle(port, lanes, wait_bit, wait_clk, levelBuf.data(), block);
+		} else {
+			PigpioPort port;
+			captureSingle(port, lanes, wait_bit, wait_clk, levelBuf.data(), block);
+		}
+		
+		Gather::packBitsMulti(levelBuf.data(), block * 8, multiMiso.data(),
+		                      multiMiso.size(), dst.data());
+		for(unsigned char *&p : dst) p += block;
+		n -= block;
+	}
 }
 
 char hwSPI::readByte() { return rx_byte(); }
@@ -133,169 +416,1992 @@ void hwSPI::writeByte(char byte) { tx_byte(byte); }
 bool hwSPI::readId(ChipId &id) { return readJedecId(id); }
 
 bool hwSPI::readJedecId(ChipId &id) {
+	const unsigned char cmd = Cmd::S25::READ_JEDEC_ID;
+	unsigned char idBytes[3];
+	
 	start();
-	tx_byte(static_cast<char>(Cmd::S25::READ_JEDEC_ID));
-	id.manufacturer = static_cast<unsigned char>(rx_byte());
-	id.memoryType   = static_cast<unsigned char>(rx_byte());
-	id.capacity     = static_cast<unsigned char>(rx_byte());
+	write(&cmd, 1);
+	read(idBytes, 3);
 	stop();
+	
+	id.manufacturer = idBytes[0];
+	id.memoryType   = idBytes[1];
+	id.capacity     = idBytes[2];
+	return true;
+}
+
+void hwSPI::clockBits(unsigned int n) {
+	for(unsigned int i = 0; i < n; i++) {
+		Timing::delay(wait_bit);
+		pinWrite(io_SCLK, 1);
+		Timing::delay(wait_clk);
+		pinWrite(io_SCLK, 0);
+	}
+}
+
+bool hwSPI::dummy(unsigned int cycles) {
+	//Whole bytes through transfer() so derived interfaces keep their timing
+	if(cycles >= 8) transfer(nullptr, nullptr, cycles / 8);
+	clockBits(cycles % 8);
 	return true;
 }
 
 /*** Splasher specific functions **********************************************/
 namespace splasher {
 
-void initRead(Device &dev, FlashInterface &hw) {
-	hwSPI *spi = dynamic_cast<hwSPI*>(&hw);
-	if (spi) {
-		spi->setTiming(dev.KHz == 0 ? 0 : static_cast<unsigned int>(dev.KHz));
-		dev.jedecValid = hw.readId(dev.jedecId);
-	}
+//Set from the signal handler, read by the loops of every operation
+static volatile sig_atomic_t stopFlag = 0;
+
+void requestStop() {
+	stopFlag = 1;
 }
 
-void initWrite(Device &dev, FlashInterface &hw) {
-	(void)dev;
-	hwSPI *spi = dynamic_cast<hwSPI*>(&hw);
-	if (spi)
-		spi->setWriteProtect(false);
+bool stopRequested() {
+	return stopFlag != 0;
 }
 
-bool readJedecId(Device &dev) {
-	if (dev.interface != IFACE::SPI) return false;
-	hwSPI dut(Pinout::SPI_SCLK, Pinout::SPI_MOSI, Pinout::SPI_MISO,
-	          Pinout::SPI_CS, Pinout::SPI_WP);
-	dut.setTiming(dev.KHz == 0 ? 0 : static_cast<unsigned int>(dev.KHz));
-	dev.jedecValid = dut.readJedecId(dev.jedecId);
-	return dev.jedecValid;
+//Clock to open an interface at in KHz, 0 for max. Auto starts slow enough for
+//any part, initRead / initWrite raise it once the chip is known
+static unsigned int s25_openKHz(const Device &dev) {
+	return dev.KHz < 0 ? Limits::PROBE_KHZ : static_cast<unsigned int>(dev.KHz);
 }
 
-void dumpFlashToFile(Device &dev, BinFile &file) {
-	if (dev.interface != IFACE::SPI || dev.protocol != PROT::S25) {
-		std::cerr << "Dump only supported for SPI/25-series. DSPI, QSPI, I2C not yet implemented." << std::endl;
-		return;
+//Requested speed for the console
+static std::string s25_speedString(const Device &dev) {
+	if(dev.KHz < 0) return "auto speed";
+	if(dev.KHz == 0) return "max speed";
+	return std::to_string(dev.KHz) + " KHz";
+}
+
+//Create the bit-banged SPI, dual or quad SPI interface on the default pinout, driven
+//by the GPIO driver selected in dev. Returns nullptr if the driver could not
+//be opened
+static std::unique_ptr<hwSPI> openSPI(Device &dev) {
+	GpioMem *mem = nullptr;
+	
+	if(dev.gpioDriver == GPIODRV::GPIOMEM) {
+		//The register block is mapped once and shared for the process lifetime
+		static GpioMem gpioMem;
+		if(!gpioMem.isOpen() && !gpioMem.open()) return nullptr;
+		mem = &gpioMem;
 	}
 	
-	std::cout << "\nReading " << dev.bytes << " bytes from offset " << dev.offset
-	          << ", at " << (dev.KHz ? std::to_string(dev.KHz) : "max")
-	          << " KHz to " << file.getFilename() << "\n\n" << std::flush;
+	std::unique_ptr<hwSPI> dut;
+	if(dev.interface == IFACE::QSPI) {
+		dut.reset(new hwQSPI(Pinout::SPI_SCLK, Pinout::SPI_MOSI,
+		          Pinout::SPI_MISO, Pinout::SPI_CS, Pinout::SPI_WP,
+		          Pinout::SPI_HOLD, mem));
+	} else if(dev.interface == IFACE::DSPI) {
+		dut.reset(new hwDSPI(Pinout::SPI_SCLK, Pinout::SPI_MOSI,
+		          Pinout::SPI_MISO, Pinout::SPI_CS, Pinout::SPI_WP, mem));
+	} else {
+		dut.reset(new hwSPI(Pinout::SPI_SCLK, Pinout::SPI_MOSI,
+		          Pinout::SPI_MISO, Pinout::SPI_CS, Pinout::SPI_WP, mem));
+	}
+	dut->setTiming(s25_openKHz(dev));
+	return dut;
+}
+
+//Create the interface selected in dev. Returns nullptr if it could not be
+//opened. Error messages are printed by the interface
+static std::unique_ptr<FlashInterface> openInterface(Device &dev) {
+	if(dev.interface == IFACE::SPIDEV) {
+		unsigned int KHz = s25_openKHz(dev);
+		unsigned int hz = (KHz == 0 ? Limits::SPIDEV_MAX_KHZ : KHz) * 1000;
+		std::unique_ptr<hwSpidev> dut(new hwSpidev(dev.spidevPath, hz));
+		if(!dut->isOpen()) return nullptr;
+		return dut;
+	}
 	
-	hwSPI dut(Pinout::SPI_SCLK, Pinout::SPI_MOSI, Pinout::SPI_MISO,
-	          Pinout::SPI_CS, Pinout::SPI_WP);
-	dut.setTiming(dev.KHz == 0 ? 0 : static_cast<unsigned int>(dev.KHz));
+	if(dev.interface == IFACE::WAVE) {
+		std::unique_ptr<hwWaveSPI> dut(new hwWaveSPI(Pinout::SPI_SCLK,
+		                               Pinout::SPI_MOSI, Pinout::SPI_MISO,
+		                               Pinout::SPI_CS, Pinout::SPI_WP));
+		dut->setTiming(s25_openKHz(dev));
+		return dut;
+	}
 	
-	initRead(dev, dut);
+	return openSPI(dev);
+}
+
+//True for the 25-series interfaces that are implemented
+static bool isSupported(const Device &dev) {
+	return (dev.interface == IFACE::SPI || dev.interface == IFACE::SPIDEV ||
+	        dev.interface == IFACE::WAVE || dev.interface == IFACE::DSPI ||
+	        dev.interface == IFACE::QSPI) &&
+	       dev.protocol == PROT::S25;
+}
+
+/*** 25-series command helpers ************************************************/
+//Put the low addrBytes bytes of addr in out, most significant first
+static void s25_addrBytes(uint64_t addr, unsigned int addrBytes,
+                          unsigned char *out) {
+	for(unsigned int i = 0; i < addrBytes; i++) {
+		out[i] = static_cast<unsigned char>((addr >> (8 * (addrBytes - 1 - i))) & 0xFF);
+	}
+}
+
+//Send a command byte followed by a 3 or 4-byte address, in one bulk write.
+//CS must already be asserted
+static void s25_cmdAddr(FlashInterface &hw, unsigned char cmd, uint64_t addr,
+                        unsigned int addrBytes = 3) {
+	unsigned char seq[5] = {cmd};
+	s25_addrBytes(addr, addrBytes, seq + 1);
+	hw.write(seq, 1 + addrBytes);
+}
+
+//Send a single byte command as its own CS cycle, e.g. Write Enable
+static void s25_command(FlashInterface &hw, unsigned char cmd) {
+	hw.start();
+	hw.write(&cmd, 1);
+	hw.stop();
+}
+
+//Lanes, mode byte and default dummy cycles of the read commands dumps can use.
+//Returns false for an unknown command
+static bool s25_readOpFor(unsigned char cmd, ReadOp &op) {
+	op = ReadOp();
+	op.cmd = cmd;
+	switch(cmd) {
+		case Cmd::S25::READ:
+			break;
+		case Cmd::S25::FAST_READ:
+			op.dummyCycles = Limits::S25_FAST_DUMMY;
+			break;
+		case Cmd::S25::DUAL_READ:
+			op.dataLanes = 2;
+			op.dummyCycles = Limits::S25_FAST_DUMMY;
+			break;
+		case Cmd::S25::DUAL_IO_READ:
+			//Mode byte 0x00 keeps the chip out of continuous read
+			op.addrLanes = 2;
+			op.dataLanes = 2;
+			op.mode = 0x00;
+			break;
+		case Cmd::S25::QUAD_READ:
+			op.dataLanes = 4;
+			op.dummyCycles = Limits::S25_FAST_DUMMY;
+			break;
+		case Cmd::S25::QUAD_IO_READ:
+			op.addrLanes = 4;
+			op.dataLanes = 4;
+			op.mode = 0x00;
+			op.dummyCycles = Limits::S25_QUAD_IO_DUMMY;
+			break;
+		case Cmd::S25::DTR_FAST_READ:
+			op.dtr = true;
+			op.dummyCycles = Limits::S25_DTR_FAST_DUMMY;
+			break;
+		case Cmd::S25::DTR_DUAL_IO_READ:
+			op.addrLanes = 2;
+			op.dataLanes = 2;
+			op.mode = 0x00;
+			op.dtr = true;
+			op.dummyCycles = Limits::S25_DTR_DUAL_DUMMY;
+			break;
+		case Cmd::S25::DTR_QUAD_IO_READ:
+			op.addrLanes = 4;
+			op.dataLanes = 4;
+			op.mode = 0x00;
+			op.dtr = true;
+			op.dummyCycles = Limits::S25_DTR_QUAD_DUMMY;
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+//Read op for a fast read mode the chip reported through SFDP. When it has
+//mode clocks, a 0x00 mode byte is driven over them and the start of the
+//dummy clocks, which keeps the chip out of continuous read
+static ReadOp s25_readOpFromCaps(const FlashCaps::Read &read) {
+	ReadOp op;
+	op.cmd = read.cmd;
+	op.addrLanes = read.addrLanes;
+	op.dataLanes = read.dataLanes;
 	
-	dut.start();
-	dut.tx_byte(Cmd::S25::READ);
-	dut.tx_byte((dev.offset >> 16) & 0xFF);
-	dut.tx_byte((dev.offset >> 8) & 0xFF);
-	dut.tx_byte(dev.offset & 0xFF);
+	const unsigned int byteClocks = 8 / read.addrLanes;
+	const unsigned int clocks = read.modeClocks + read.dummyClocks;
+	if(read.modeClocks != 0 && clocks >= byteClocks) {
+		op.mode = 0x00;
+		op.dummyCycles = clocks - byteClocks;
+	} else {
+		op.dummyCycles = clocks;
+	}
+	return op;
+}
+
+//Read command for a dump. dev.readCmd and dev.dummyCycles when given, with
+//the chip's own dummy clocks when SFDP lists that command.
+//Otherwise the widest SFDP read the interface can do. Without SFDP, Quad or
+//Dual Output Read on a quad or dual interface unless the chip database says
+//the part lacks it, or Fast Read once the clock is above what Read (0x03) is
+//rated for.
+//randomAccess is for short reads at scattered addresses: Quad then Dual I/O
+//Read comes first when SFDP lists it with mode clocks, or the chip database
+//knows the part and does not rule it out, so the reads can stay in continuous
+//read and skip the opcode.
+//A part whose QE bit cannot be read back (QER 1) gets no quad reads
+static ReadOp s25_selectRead(const Device &dev, const FlashInterface &hw,
+                             unsigned int clockKHz, bool randomAccess = false) {
+	const FlashCaps &caps = dev.caps;
+	const ChipDb::Chip *chip = dev.chip;
+	unsigned char cmd = dev.readCmd;
+	const unsigned int lanes = (caps.valid && caps.qe == FlashCaps::QE::SR2_BIT1_NO_READ)
+	                         ? std::min(hw.maxLanes(), 2u) : hw.maxLanes();
+	if(cmd == 0 && randomAccess) {
+		if(caps.valid) {
+			for(const FlashCaps::Read *read : {&caps.read144, &caps.read122}) {
+				if(read->supported && read->modeClocks != 0 &&
+				   read->addrLanes <= lanes) {
+					cmd = read->cmd;
+					break;
+				}
+			}
+		} else if(chip) {
+			if(lanes >= 4 && !chip->has(ChipDb::Quirk::NO_QUAD)) {
+				cmd = Cmd::S25::QUAD_IO_READ;
+			} else if(lanes >= 2 && !chip->has(ChipDb::Quirk::NO_DUAL)) {
+				cmd = Cmd::S25::DUAL_IO_READ;
+			}
+		}
+	}
+	if(cmd == 0 && caps.valid) {
+		for(const FlashCaps::Read *read : {&caps.read114, &caps.read144,
+		                                   &caps.read112, &caps.read122}) {
+			if(read->supported && read->dataLanes <= lanes &&
+			   read->addrLanes <= lanes) {
+				cmd = read->cmd;
+				break;
+			}
+		}
+	}
 	
-	unsigned long KiBDone = 0;
-	unsigned long maxByte = dev.bytes + 1;
-	for(unsigned long cByte = 1; cByte < maxByte; cByte++) {
-		file.pushByteToArray(dut.readByte());
-		if(cByte % 1024 == 0) {
-			++KiBDone;
-			std::cout << "\rDumped " << KiBDone << "KiB" << std::flush;
+	if(cmd == 0) {
+		const bool quad = !chip || !chip->has(ChipDb::Quirk::NO_QUAD);
+		const bool dual = !chip || !chip->has(ChipDb::Quirk::NO_DUAL);
+		const unsigned int readMaxKHz = chip ? chip->readMHz * 1000u
+		                                     : Limits::S25_READ_MAX_KHZ;
+		if(lanes >= 4 && quad) {
+			cmd = Cmd::S25::QUAD_READ;
+		} else if(lanes >= 2 && dual) {
+			cmd = Cmd::S25::DUAL_READ;
+		} else {
+			cmd = (clockKHz > readMaxKHz) ? Cmd::S25::FAST_READ : Cmd::S25::READ;
 		}
 	}
 	
-	std::cout << "\n\nFinished dumping to " << file.getFilename() << std::endl;
-	dut.stop();
+	ReadOp op;
+	const FlashCaps::Read *sfdpRead = caps.valid ? caps.findRead(cmd) : nullptr;
+	if(sfdpRead != nullptr) {
+		op = s25_readOpFromCaps(*sfdpRead);
+	} else {
+		s25_readOpFor(cmd, op);
+	}
+	if(dev.dummyCycles >= 0) op.dummyCycles = static_cast<unsigned int>(dev.dummyCycles);
+	return op;
 }
 
-static void s25_waitBusy(hwSPI &dut) {
+//Poll WIP until the chip is idle. A timeoutUs of 0 waits as long as it takes,
+//otherwise returns false once it has passed. Also returns false when a stop
+//is requested, unless stoppable is false, for the waits that restore the
+//chip's state on the way out
+static bool s25_waitBusy(FlashInterface &hw, uint64_t timeoutUs = 0,
+                         bool stoppable = true) {
+	const unsigned char cmd = Cmd::S25::READ_STATUS;
+	const uint64_t startNs = Timing::nowNs();
+	unsigned char st;
 	while (true) {
-		dut.start();
-		dut.tx_byte(Cmd::S25::READ_STATUS);
-		unsigned char st = static_cast<unsigned char>(dut.rx_byte());
-		dut.stop();
-		if ((st & 1) == 0) break;  // WIP bit clear
+		hw.start();
+		hw.write(&cmd, 1);
+		hw.read(&st, 1);
+		hw.stop();
+		if (hw.failed()) {
+			std::cerr << "Error: Status read failed" << std::endl;
+			return false;
+		}
+		if ((st & 1) == 0) return true;  // WIP bit clear
+		if (stoppable && stopRequested()) return false;
+		if (timeoutUs != 0 && Timing::nowNs() - startNs > timeoutUs * 1000) {
+			std::cerr << "Error: Chip still busy after " << timeoutUs / 1000
+			          << "ms" << std::endl;
+			return false;
+		}
 	}
 }
 
-void writeFileToFlash(Device &dev, BinFile &file) {
-	if (dev.interface != IFACE::SPI || dev.protocol != PROT::S25) {
-		std::cerr << "Write only supported for SPI/25-series. DSPI, QSPI, I2C not yet implemented." << std::endl;
-		return;
+static unsigned char s25_readStatus(FlashInterface &hw, unsigned char cmd) {
+	unsigned char st = 0;
+	hw.start();
+	hw.write(&cmd, 1);
+	hw.read(&st, 1);
+	hw.stop();
+	return st;
+}
+
+/*** Chip database ***********************************************************/
+//Size of the chip, from SFDP or the database. 0 when neither knows it
+static uint64_t s25_chipBytes(const Device &dev) {
+	if(dev.caps.valid && dev.caps.bytes != 0) return dev.caps.bytes;
+	return dev.chip ? dev.chip->bytes : 0;
+}
+
+//Quad Enable location, from SFDP or the database. UNKNOWN leaves it to the
+//manufacturer, see QuadEnable
+static FlashCaps::QE s25_qeFor(const Device &dev) {
+	if(dev.caps.valid && dev.caps.qe != FlashCaps::QE::UNKNOWN) return dev.caps.qe;
+	if(dev.chip != nullptr) {
+		if(dev.chip->has(ChipDb::Quirk::QE_SR2_BIT1)) return FlashCaps::QE::SR2_BIT1;
+		if(dev.chip->has(ChipDb::Quirk::QE_SR1_BIT6)) return FlashCaps::QE::SR1_BIT6;
+		if(dev.chip->has(ChipDb::Quirk::QE_NONE)) return FlashCaps::QE::NONE;
 	}
-	if (!file.isReadMode()) {
-		std::cerr << "Write requires a file opened for reading." << std::endl;
-		return;
+	return FlashCaps::QE::UNKNOWN;
+}
+
+//Program and erase timeouts: twice the database maximum for the part, or the
+//generic figures, and never less than Limits::BUSY_MIN_US
+static const ChipDb::Timing &s25_times(const Device &dev) {
+	return dev.chip ? dev.chip->times() : ChipDb::GENERIC_TIMING;
+}
+
+static uint64_t s25_busyUs(uint64_t maxUs) {
+	return std::max<uint64_t>(maxUs * 2, Limits::BUSY_MIN_US);
+}
+
+static uint64_t s25_programUs(const Device &dev) {
+	return s25_busyUs(s25_times(dev).ppMaxUs);
+}
+
+//Anything over a 4 KiB sector is timed as 64 KiB blocks
+static uint64_t s25_eraseUs(const Device &dev, uint32_t eraseBytes) {
+	const ChipDb::Timing &t = s25_times(dev);
+	if(eraseBytes <= Limits::S25_SECTOR_SIZE && t.seMaxMs != 0) {
+		return s25_busyUs(t.seMaxMs * 1000ull);
 	}
-	std::cout << "\nWriting " << dev.bytes << " bytes from " << file.getFilename()
-	          << " to flash at offset " << dev.offset << "\n\n" << std::flush;
-	hwSPI dut(Pinout::SPI_SCLK, Pinout::SPI_MOSI, Pinout::SPI_MISO,
-	          Pinout::SPI_CS, Pinout::SPI_WP);
-	dut.setTiming(dev.KHz == 0 ? 0 : static_cast<unsigned int>(dev.KHz));
-	initWrite(dev, dut);
-	unsigned long addr = dev.offset;
-	unsigned long remaining = dev.bytes;
-	unsigned long KiBDone = 0;
-	while (remaining > 0) {
-		unsigned int chunk = static_cast<unsigned int>(remaining > Limits::S25_PAGE_SIZE ? Limits::S25_PAGE_SIZE : remaining);
-		dut.start();
-		dut.tx_byte(Cmd::S25::WRITE_ENABLE);
-		dut.stop();
-		dut.start();
-		dut.tx_byte(Cmd::S25::PAGE_PROGRAM);
-		dut.tx_byte((addr >> 16) & 0xFF);
-		dut.tx_byte((addr >> 8) & 0xFF);
-		dut.tx_byte(addr & 0xFF);
-		for (unsigned int i = 0; i < chunk; i++) {
-			char b;
-			if (!file.pullByteFromFile(b)) break;
-			dut.tx_byte(b);
+	const uint64_t blocks = (eraseBytes + 65535u) / 65536u;
+	return s25_busyUs(t.beMaxMs * 1000ull * blocks);
+}
+
+//0, no timeout, when the size of the chip is not known
+static uint64_t s25_chipEraseUs(const Device &dev) {
+	const uint64_t bytes = s25_chipBytes(dev);
+	if(bytes == 0) return 0;
+	const uint64_t MiB = std::max<uint64_t>(1, (bytes + 1048575u) / 1048576u);
+	return s25_busyUs(s25_times(dev).ceMaxMsPerMiB * 1000ull * MiB);
+}
+
+//Longest the chip can stay busy, a chip erase. Bounded by the largest chip
+//when the size is not known. For the waits that put the chip back on the
+//way out, which must not hang
+static uint64_t s25_idleUs(const Device &dev) {
+	const uint64_t us = s25_chipEraseUs(dev);
+	return us != 0 ? us : s25_eraseUs(dev, Limits::MAX_BYTES);
+}
+
+/*** 4-byte addressing ********************************************************/
+//4-byte opcode of a 3-byte address command. Commands without one, or without
+//an address, are returned as they are
+static unsigned char s25_opcode4(unsigned char cmd) {
+	switch(cmd) {
+		case Cmd::S25::READ:             return Cmd::S25::READ_4B;
+		case Cmd::S25::FAST_READ:        return Cmd::S25::FAST_READ_4B;
+		case Cmd::S25::DUAL_READ:        return Cmd::S25::DUAL_READ_4B;
+		case Cmd::S25::DUAL_IO_READ:     return Cmd::S25::DUAL_IO_READ_4B;
+		case Cmd::S25::QUAD_READ:        return Cmd::S25::QUAD_READ_4B;
+		case Cmd::S25::QUAD_IO_READ:     return Cmd::S25::QUAD_IO_READ_4B;
+		case Cmd::S25::DTR_FAST_READ:    return Cmd::S25::DTR_FAST_READ_4B;
+		case Cmd::S25::DTR_DUAL_IO_READ: return Cmd::S25::DTR_DUAL_IO_READ_4B;
+		case Cmd::S25::DTR_QUAD_IO_READ: return Cmd::S25::DTR_QUAD_IO_READ_4B;
+		case Cmd::S25::PAGE_PROGRAM:     return Cmd::S25::PAGE_PROGRAM_4B;
+		case Cmd::S25::SECTOR_ERASE_4K:  return Cmd::S25::SECTOR_ERASE_4K_4B;
+		case Cmd::S25::BLOCK_ERASE_32K:  return Cmd::S25::BLOCK_ERASE_32K_4B;
+		case Cmd::S25::BLOCK_ERASE_64K:  return Cmd::S25::BLOCK_ERASE_64K_4B;
+		default:                         return cmd;
+	}
+}
+
+//Addressing for an access that ends at end, see ADDRMODE. Holds the chip in
+//that mode for its lifetime:
+//  OPCODES   commands are swapped for their 4-byte versions
+//  ENTER     0xB7 now, 0xE9 once the chip is idle again
+//  BANK      commands stay 3-byte, select() writes bits 24-31 to the extended
+//            address register (0xC5) when an access moves bank. A command
+//            cannot cross a bank, spanEnd() says where to restart it.
+//            Bank 0 is put back afterwards
+//AUTO is plain 3-byte up to 16 MiB. Above that it is whichever way SFDP
+//lists first of OPCODES, ENTER and BANK. Without SFDP it is ENTER for parts
+//the chip database lists as 0xB7 only, otherwise OPCODES.
+//An access past the SFDP or database size is refused.
+class AddressMode {
+	public:
+	AddressMode(FlashInterface &hw, const Device &dev, uint64_t end)
+		: hw(hw), mode(dev.addrMode) {
+		const FlashCaps &caps = dev.caps;
+		const uint64_t chipBytes = s25_chipBytes(dev);
+		if(chipBytes != 0 && end > chipBytes) {
+			std::cerr << "Error: Access ends at " << end << ", the chip is "
+			          << chipBytes << " bytes" << std::endl;
+			ok = false;
+			return;
 		}
-		dut.stop();
-		s25_waitBusy(dut);
-		addr += chunk;
-		remaining -= chunk;
-		if ((dev.bytes - remaining) / 1024 > KiBDone) {
-			KiBDone = (dev.bytes - remaining) / 1024;
-			std::cout << "\rWritten " << KiBDone << " KiB" << std::flush;
+		
+		const bool needs4 = end > Limits::S25_BANK_BYTES;
+		if(mode == ADDRMODE::AUTO) {
+			mode = ADDRMODE::THREE;
+			if(needs4) {
+				mode = ADDRMODE::OPCODES;
+				if(caps.valid && !caps.opcodes4) {
+					if(caps.enter4Cmd) mode = ADDRMODE::ENTER;
+					else if(caps.enter4Ear) mode = ADDRMODE::BANK;
+				} else if(!caps.valid && dev.chip &&
+				          dev.chip->has(ChipDb::Quirk::ADDR4_ENTER)) {
+					mode = ADDRMODE::ENTER;
+				}
+			}
+		}
+		
+		if(mode == ADDRMODE::THREE && needs4) {
+			std::cerr << "Error: 3-byte addresses only reach 16 MiB, use 4-byte "
+			          << "addressing to access up to " << end << std::endl;
+			ok = false;
+		} else if(mode == ADDRMODE::ENTER) {
+			//Some parts only take 0xB7 with WEL set, the rest ignore it
+			s25_command(hw, Cmd::S25::WRITE_ENABLE);
+			s25_command(hw, Cmd::S25::ENTER_4B);
+			entered = true;
 		}
 	}
-	std::cout << "\n\nFinished writing to flash." << std::endl;
-}
+	
+	~AddressMode() {
+		//A busy chip ignores the commands, wait out the last program/erase
+		if(entered || bank != 0) s25_waitBusy(hw);
+		if(entered) s25_command(hw, Cmd::S25::EXIT_4B);
+		if(bank != 0) writeBank(0);
+	}
+	
+	//False if the access cannot be addressed
+	bool valid() const { return ok; }
+	
+	unsigned int addrBytes() const {
+		return (mode == ADDRMODE::OPCODES || mode == ADDRMODE::ENTER) ? 4 : 3;
+	}
+	
+	//Command byte to send for a 3-byte address command
+	unsigned char command(unsigned char cmd) const {
+		return (mode == ADDRMODE::OPCODES) ? s25_opcode4(cmd) : cmd;
+	}
+	
+	//Switch a read op to this addressing
+	void apply(ReadOp &op) const {
+		op.cmd = command(op.cmd);
+		op.addrBytes = addrBytes();
+	}
+	
+	//Make addr reachable, with CS released. Returns false if the bank
+	//register did not take the new bank
+	bool select(uint64_t addr) {
+		if(mode != ADDRMODE::BANK) return true;
+		
+		unsigned char want = static_cast<unsigned char>(addr >> 24);
+		if(want == bank) return true;
+		writeBank(want);
+		if(s25_readStatus(hw, Cmd::S25::READ_EAR) != want) {
+			std::cerr << "Error: Bank register did not take bank " << (int)want
+			          << std::endl;
+			return false;
+		}
+		bank = want;
+		return true;
+	}
+	
+	//First address past what one command starting at addr can reach
+	uint64_t spanEnd(uint64_t addr) const {
+		if(mode != ADDRMODE::BANK) return UINT64_MAX;
+		return (addr | (Limits::S25_BANK_BYTES - 1)) + 1;
+	}
+	
+	private:
+	void writeBank(unsigned char value) {
+		const unsigned char seq[2] = {Cmd::S25::WRITE_EAR, value};
+		s25_command(hw, Cmd::S25::WRITE_ENABLE);
+		hw.start();
+		hw.write(seq, 2);
+		hw.stop();
+	}
+	
+	FlashInterface &hw;
+	ADDRMODE mode;
+	unsigned char bank = 0;
+	bool entered = false;
+	bool ok = true;
+}; //class AddressMode
 
-void eraseFlash(Device &dev, unsigned long byteCount) {
-	if (dev.interface != IFACE::SPI || dev.protocol != PROT::S25) {
-		std::cerr << "Erase only supported for SPI/25-series. DSPI, QSPI, I2C not yet implemented." << std::endl;
-		return;
+/*** Status register unlock ***************************************************/
+//SST25 and AT25DF parts power up with every block protected by the status
+//register (BP/SWP bits 2-5, BPL/SPRL bit 7). Clears them with WRSR 0x00 for
+//its lifetime and writes the old value back afterwards. AT25DF sectors
+//protected one by one cannot be put back through WRSR, that is reported
+class StatusUnlock {
+	public:
+	StatusUnlock(FlashInterface &hw, const Device &dev) : hw(hw) {
+		if(!dev.chip || !dev.chip->has(ChipDb::Quirk::UNLOCK_SR)) return;
+		idleUs = s25_idleUs(dev);
+		
+		sr = s25_readStatus(hw, Cmd::S25::READ_STATUS);
+		if((sr & PROTECT_BITS) == 0) return;
+		writeStatus(0x00);
+		changed = true;
+		std::cout << "Block protection cleared (status 0x" << std::hex << (int)sr
+		          << std::dec << "), restored when done\n";
+		if(s25_readStatus(hw, Cmd::S25::READ_STATUS) & PROTECT_BITS) {
+			std::cout << "Warning: Block protection is still set, is WP held low?\n";
+		}
 	}
-	hwSPI dut(Pinout::SPI_SCLK, Pinout::SPI_MOSI, Pinout::SPI_MISO,
-	          Pinout::SPI_CS, Pinout::SPI_WP);
-	dut.setTiming(dev.KHz == 0 ? 0 : static_cast<unsigned int>(dev.KHz));
-	initWrite(dev, dut);
-	dut.start();
-	dut.tx_byte(Cmd::S25::WRITE_ENABLE);
-	dut.stop();
-	dut.start();
-	if (byteCount == 0) {
-		dut.tx_byte(Cmd::S25::CHIP_ERASE);
-		std::cout << "Chip erase started (full device)." << std::endl;
-	} else {
-		// Sector erase 4KB at a time
-		unsigned long addr = dev.offset;
-		unsigned long end = dev.offset + byteCount;
-		while (addr < end) {
-			dut.start();
-			dut.tx_byte(Cmd::S25::WRITE_ENABLE);
-			dut.stop();
-			dut.start();
-			dut.tx_byte(Cmd::S25::SECTOR_ERASE_4K);
-			dut.tx_byte((addr >> 16) & 0xFF);
-			dut.tx_byte((addr >> 8) & 0xFF);
-			dut.tx_byte(addr & 0xFF);
-			dut.stop();
-			s25_waitBusy(dut);
-			addr += 4096;
+	
+	~StatusUnlock() {
+		if(!changed) return;
+		//A busy chip ignores WRSR, wait out the last program/erase
+		s25_waitBusy(hw, idleUs, false);
+		writeStatus(sr);
+		const unsigned char now = s25_readStatus(hw, Cmd::S25::READ_STATUS);
+		if((now & PROTECT_BITS) != (sr & PROTECT_BITS)) {
+			std::cerr << "Warning: Block protection is now status 0x" << std::hex
+			          << (int)now << ", it was 0x" << (int)sr << std::dec << std::endl;
+		}
+	}
+	
+	private:
+	static const unsigned char PROTECT_BITS = 0xBC;
+	
+	void writeStatus(unsigned char st) {
+		const unsigned char seq[2] = {Cmd::S25::WRITE_STATUS, st};
+		s25_command(hw, Cmd::S25::WRITE_ENABLE);
+		hw.start();
+		hw.write(seq, 2);
+		hw.stop();
+		s25_waitBusy(hw, idleUs, false);
+	}
+	
+	FlashInterface &hw;
+	uint64_t idleUs = 0;
+	unsigned char sr = 0;
+	bool changed = false;
+}; //class StatusUnlock
+
+/*** Quad Enable **************************************************************/
+//Quad reads need the chip's QE bit set, otherwise IO2/IO3 are still WP and
+//HOLD. Where it lives depends on the vendor:
+//  Winbond, GigaDevice   SR2 bit 1, written with SR1 as 0x01 SR1 SR2
+//  Macronix              SR bit 6, written as 0x01 SR
+//Other parts are left alone, many have quad always enabled. The location
+//SFDP or the chip database reports is used over the vendor when there is one.
+//SFDP can also ask for SR2 to be written on its own with 0x31, or say SR2
+//cannot be read, which is refused as QE could not be put back.
+//Sets QE for its lifetime and puts the status registers back afterwards.
+//The chip may be programming or erasing when the status is written, so each
+//write first waits up to idleUs for it, even after a stop request
+class QuadEnable {
+	public:
+	QuadEnable(FlashInterface &hw, const ChipId &id, FlashCaps::QE qe,
+	           uint64_t idleUs)
+		: hw(hw), idleUs(idleUs) {
+		switch(qe) {
+			case FlashCaps::QE::NONE:           return;
+			case FlashCaps::QE::SR2_BIT1:       scheme = Scheme::SR2_BIT1;  break;
+			case FlashCaps::QE::SR2_BIT1_WRSR2: scheme = Scheme::SR2_WRSR2; break;
+			case FlashCaps::QE::SR1_BIT6:       scheme = Scheme::SR1_BIT6;  break;
+			case FlashCaps::QE::SR2_BIT1_NO_READ:
+				std::cerr << "Error: Quad Enable is in status register 2, which "
+				          << "this part cannot read back. Use a dual or single "
+				          << "read with -r" << std::endl;
+				ok = false;
+				return;
+			case FlashCaps::QE::SR2_BIT7:
+				std::cout << "Quad Enable: SR2 bit 7 (0x3E) is not supported, "
+				          << "assuming quad is enabled\n";
+				return;
+			case FlashCaps::QE::UNKNOWN:
+				switch(id.manufacturer) {
+					case 0xEF: case 0xC8: scheme = Scheme::SR2_BIT1; break;
+					case 0xC2:            scheme = Scheme::SR1_BIT6; break;
+					default:              scheme = Scheme::NONE;     break;
+				}
+				break;
+		}
+		
+		if(scheme == Scheme::NONE) {
+			std::cout << "Quad Enable: unknown manufacturer 0x" << std::hex
+			          << (int)id.manufacturer << std::dec
+			          << ", assuming quad is enabled\n";
+			return;
+		}
+		
+		readStatus(sr1, sr2);
+		if(isSet(sr1, sr2)) return;
+		
+		if(scheme == Scheme::SR1_BIT6) {
+			writeStatus(static_cast<unsigned char>(sr1 | 0x40), sr2);
+		} else {
+			writeStatus(sr1, static_cast<unsigned char>(sr2 | 0x02));
+		}
+		
+		//Reading it back catches a locked status register (SRP/WP)
+		unsigned char now1, now2;
+		readStatus(now1, now2);
+		changed = true;
+		ok = isSet(now1, now2);
+		if(!ok) std::cerr << "Error: Cannot set the Quad Enable bit" << std::endl;
+	}
+	
+	~QuadEnable() {
+		if(!changed) return;
+		const bool wrote = writeStatus(sr1, sr2);
+		unsigned char now1, now2;
+		readStatus(now1, now2);
+		if(!wrote || isSet(now1, now2)) {
+			std::cerr << "Error: Could not restore the status registers, Quad "
+			          << "Enable is still set" << std::endl;
+		}
+	}
+	
+	//False if QE could not be set
+	bool valid() const { return ok; }
+	
+	private:
+	//SR2_WRSR2 parts write SR2 on its own with 0x31 (QER 6)
+	enum class Scheme { NONE, SR2_BIT1, SR2_WRSR2, SR1_BIT6 };
+	
+	bool isSet(unsigned char st1, unsigned char st2) const {
+		return (scheme == Scheme::SR1_BIT6) ? (st1 & 0x40) != 0 : (st2 & 0x02) != 0;
+	}
+	
+	void readStatus(unsigned char &st1, unsigned char &st2) {
+		st1 = s25_readStatus(hw, Cmd::S25::READ_STATUS);
+		st2 = (scheme == Scheme::SR1_BIT6) ? 0 : s25_readStatus(hw, Cmd::S25::READ_STATUS2);
+	}
+	
+	//False if the chip stayed busy before or after the write
+	bool writeStatus(unsigned char st1, unsigned char st2) {
+		if(!s25_waitBusy(hw, idleUs, false)) return false;
+		const unsigned char seq[3] = {Cmd::S25::WRITE_STATUS, st1, st2};
+		const unsigned char seq2[2] = {Cmd::S25::WRITE_STATUS2, st2};
+		s25_command(hw, Cmd::S25::WRITE_ENABLE);
+		hw.start();
+		switch(scheme) {
+			case Scheme::SR2_BIT1:  hw.write(seq, 3);  break;
+			case Scheme::SR2_WRSR2: hw.write(seq2, 2); break;
+			default:                hw.write(seq, 2);  break;
+		}
+		hw.stop();
+		return s25_waitBusy(hw, idleUs, false);
+	}
+	
+	FlashInterface &hw;
+	uint64_t idleUs;
+	Scheme scheme = Scheme::NONE;
+	unsigned char sr1 = 0, sr2 = 0;
+	bool changed = false;
+	bool ok = true;
+}; //class QuadEnable
+
+/*** QPI session **************************************************************/
+//Puts the chip and a hwQSPI into QPI (4-4-4) mode for its lifetime, so the
+//opcode of every command costs 2 clocks instead of 8. Enter/exit commands:
+//  Winbond, GigaDevice   0x38 / 0xFF (needs QE, set through QuadEnable)
+//  Macronix              0x35 / 0xF5
+//Entry is checked by reading the status register in QPI. The destructor
+//waits up to idleUs for any program or erase to finish, as a busy chip
+//ignores the exit, then leaves QPI before QE is restored.
+class QpiSession {
+	public:
+	QpiSession(hwQSPI &hw, const ChipId &id, FlashCaps::QE qe, uint64_t idleUs)
+		: hw(hw), idleUs(idleUs) {
+		switch(id.manufacturer) {
+			case 0xEF: case 0xC8:
+				enterCmd = Cmd::S25::ENTER_QPI;
+				exitCmd = Cmd::S25::EXIT_QPI;
+				break;
+			case 0xC2:
+				enterCmd = Cmd::S25::ENTER_QPI_MX;
+				exitCmd = Cmd::S25::EXIT_QPI_MX;
+				break;
+			default:
+				std::cerr << "Error: QPI mode is not known for manufacturer 0x"
+				          << std::hex << (int)id.manufacturer << std::dec
+				          << std::endl;
+				return;
+		}
+		
+		quad.reset(new QuadEnable(hw, id, qe, idleUs));
+		if(!quad->valid()) return;
+		
+		//Status bits other than WEL/WIP must read the same both ways
+		unsigned char before = s25_readStatus(hw, Cmd::S25::READ_STATUS) & 0xFC;
+		s25_command(hw, enterCmd);
+		hw.setQpi(true);
+		active = true;
+		
+		unsigned char after = s25_readStatus(hw, Cmd::S25::READ_STATUS) & 0xFC;
+		if(after != before) {
+			std::cerr << "Error: Chip did not enter QPI mode" << std::endl;
+			leave();
+			return;
+		}
+		ok = true;
+	}
+	
+	~QpiSession() {
+		leave();
+	}
+	
+	//False if the chip could not be put in QPI mode, the interface is
+	//then back in SPI mode
+	bool valid() const { return ok; }
+	
+	//Exit QPI now. Called by the destructor
+	void leave() {
+		if(active) {
+			hw.stop();
+			s25_waitBusy(hw, idleUs, false);
+			s25_command(hw, exitCmd);
+			hw.setQpi(false);
+			active = false;
+		}
+		quad.reset();
+		ok = false;
+	}
+	
+	private:
+	hwQSPI &hw;
+	uint64_t idleUs;
+	unsigned char enterCmd = 0, exitCmd = 0;
+	std::unique_ptr<QuadEnable> quad;
+	bool active = false;
+	bool ok = false;
+}; //class QpiSession
+
+//Open a QPI session on hw when dev asks for one. Returns false if QPI was
+//asked for but could not be entered
+static bool s25_openQpi(const Device &dev, FlashInterface &hw,
+                        std::unique_ptr<QpiSession> &session) {
+	if(!dev.qpi) return true;
+	
+	hwQSPI *qspi = dynamic_cast<hwQSPI *>(&hw);
+	if(qspi == nullptr) {
+		std::cerr << "Error: QPI mode needs the qspi interface" << std::endl;
+		return false;
+	}
+	
+	ChipId id;
+	if(!hw.readId(id)) id = ChipId{0, 0, 0};
+	//Leaving waits out a chip erase at worst
+	session.reset(new QpiSession(*qspi, id, s25_qeFor(dev), s25_idleUs(dev)));
+	if(!session->valid()) return false;
+	
+	std::cout << "QPI mode entered\n";
+	return true;
+}
+
+/*** SFDP *********************************************************************/
+//Read n bytes of the SFDP space from addr, single lane with 8 dummy clocks
+static void s25_readSfdp(FlashInterface &hw, uint32_t addr, unsigned char *buf,
+                         size_t n) {
+	hw.start();
+	s25_cmdAddr(hw, Sfdp::READ_CMD, addr);
+	hw.dummy(Sfdp::DUMMY_CLOCKS);
+	hw.read(buf, n);
+	hw.stop();
+}
+
+//Fill caps from the chip's Basic Flash Parameter Table, the newest one when
+//several are listed. caps stays invalid for chips without SFDP
+static bool s25_readCaps(FlashInterface &hw, FlashCaps &caps) {
+	caps = FlashCaps();
+	unsigned char header[Sfdp::HEADER_BYTES];
+	s25_readSfdp(hw, 0, header, sizeof(header));
+	unsigned int tables = Sfdp::parseHeader(header, caps);
+	if(tables == 0) return false;
+	
+	std::vector<unsigned char> headers(tables * Sfdp::HEADER_BYTES);
+	s25_readSfdp(hw, Sfdp::HEADER_BYTES, headers.data(), headers.size());
+	
+	bool found = false;
+	Sfdp::Table bfpt = {};
+	for(unsigned int i = 0; i < tables; i++) {
+		Sfdp::Table t = Sfdp::parseTable(headers.data() + i * Sfdp::HEADER_BYTES);
+		if(t.id == Sfdp::BFPT_ID && t.revMajor == 1 &&
+		   (!found || t.revMinor >= bfpt.revMinor)) {
+			bfpt = t;
+			found = true;
+		}
+	}
+	if(!found) return false;
+	
+	unsigned int dwords = std::min(bfpt.dwords, Sfdp::BFPT_MAX_DWORDS);
+	std::vector<unsigned char> table(dwords * 4);
+	s25_readSfdp(hw, bfpt.pointer, table.data(), table.size());
+	return Sfdp::parseBfpt(table.data(), dwords, caps);
+}
+
+/*** Program and check reads *************************************************/
+//Page size from SFDP or the chip database, otherwise 256
+static unsigned int s25_pageSize(const Device &dev) {
+	return dev.caps.valid ? dev.caps.pageSize
+	     : dev.chip ? dev.chip->pageSize : Limits::S25_PAGE_SIZE;
+}
+
+//Program n bytes at addr, which must not cross a page boundary. Returns
+//false if the address could not be selected or the chip stayed busy.
+//stoppable false waits out the program even after a stop request
+static bool s25_program(const Device &dev, FlashInterface &hw,
+                        AddressMode &addrMode, uint64_t addr,
+                        const unsigned char *data, size_t n,
+                        bool stoppable = true) {
+	if(!addrMode.select(addr)) return false;
+	s25_command(hw, Cmd::S25::WRITE_ENABLE);
+	hw.start();
+	s25_cmdAddr(hw, addrMode.command(Cmd::S25::PAGE_PROGRAM), addr, addrMode.addrBytes());
+	hw.write(data, n);
+	hw.stop();
+	return s25_waitBusy(hw, s25_programUs(dev), stoppable);
+}
+
+//Read command for looking at the chip before changing it, the one a dump
+//would use. Quad commands set QE, held by quad. In QPI mode every command is
+//4-4-4, which the dump reads are not, so the option asking for the read,
+//what, is refused there
+static bool s25_checkRead(const Device &dev, FlashInterface &hw,
+                          const AddressMode &addrMode, const char *what,
+                          ReadOp &op, std::unique_ptr<QuadEnable> &quad) {
+	if(dev.qpi) {
+		std::cerr << "Error: " << what << " cannot be used with --qpi" << std::endl;
+		return false;
+	}
+	
+	op = s25_selectRead(dev, hw, hw.clockKHz());
+	addrMode.apply(op);
+	if(op.dataLanes == 4 || op.addrLanes == 4) {
+		ChipId id = dev.jedecValid ? dev.jedecId : ChipId{0, 0, 0};
+		quad.reset(new QuadEnable(hw, id, s25_qeFor(dev), s25_idleUs(dev)));
+		if(!quad->valid()) return false;
+	}
+	return true;
+}
+
+//Read n bytes from addr with op, in one command. The address must be
+//selected already. Returns false if the read failed, buf then holds no data
+static bool s25_readSpan(FlashInterface &hw, const ReadOp &op, uint64_t addr,
+                         unsigned char *buf, size_t n) {
+	hw.start();
+	if(!hw.beginRead(op, addr)) {
+		hw.stop();
+		return false;
+	}
+	if(op.dtr) {
+		hw.readDtr(buf, n, op.dataLanes);
+	} else {
+		hw.readWide(buf, n, op.dataLanes);
+	}
+	hw.stop();
+	if(hw.failed()) {
+		std::cerr << "Error: Read failed at 0x" << std::hex << addr << std::dec << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/*** Erase ******************************************************************/
+//Erase commands of the chip, from SFDP or the chip database. Without either,
+//the 4 KiB sector and 64 KiB block erases nearly every part has
+static std::vector<ErasePlan::Type> s25_eraseTypes(const Device &dev) {
+	const ChipDb::Timing &times = s25_times(dev);
+	std::vector<ErasePlan::Type> types;
+	auto add = [&](uint32_t bytes, unsigned char cmd) {
+		types.push_back(ErasePlan::Type{bytes, cmd, ErasePlan::typicalMs(times, bytes)});
+	};
+	
+	if(dev.caps.valid && dev.caps.smallestErase() != nullptr) {
+		for(const FlashCaps::Erase &e : dev.caps.erase) {
+			if(e.bytes != 0) add(e.bytes, e.cmd);
+		}
+	} else if(dev.chip) {
+		if(dev.chip->erase & ChipDb::ERASE_4K)   add(4096, Cmd::S25::SECTOR_ERASE_4K);
+		if(dev.chip->erase & ChipDb::ERASE_32K)  add(32768, Cmd::S25::BLOCK_ERASE_32K);
+		if(dev.chip->erase & ChipDb::ERASE_64K)  add(65536, Cmd::S25::BLOCK_ERASE_64K);
+		if(dev.chip->erase & ChipDb::ERASE_256K) add(262144, Cmd::S25::BLOCK_ERASE_64K);
+	} else {
+		add(Limits::S25_SECTOR_SIZE, Cmd::S25::SECTOR_ERASE_4K);
+		add(65536, Cmd::S25::BLOCK_ERASE_64K);
+	}
+	return types;
+}
+
+//Print the block sizes a plan uses and its typical time
+static void s25_printPlan(const ErasePlan::Plan &plan) {
+	std::vector<std::pair<uint32_t, size_t>> counts;
+	for(const ErasePlan::Step &step : plan.steps) {
+		auto it = std::find_if(counts.begin(), counts.end(),
+		          [&](const std::pair<uint32_t, size_t> &c) { return c.first == step.bytes; });
+		if(it == counts.end()) counts.emplace_back(step.bytes, 1);
+		else it->second++;
+	}
+	
+	std::cout << "Erase plan:";
+	for(const std::pair<uint32_t, size_t> &c : counts) {
+		std::cout << " " << c.second << " x " << c.first / 1024 << "KiB";
+	}
+	std::cout << ", about " << plan.typMs / 1000.0 << "s\n";
+}
+
+//True if the n bytes from addr all read 0xFF. One read command, ended at
+//the first sector with data in it. CS must be free and the address selected
+static bool s25_isErased(FlashInterface &hw, const ReadOp &op, uint64_t addr,
+                         uint64_t n) {
+	std::vector<unsigned char> buf(Limits::S25_SECTOR_SIZE);
+	hw.start();
+	if(!hw.beginRead(op, addr)) {
+		hw.stop();
+		return false;
+	}
+	bool erased = true;
+	for(uint64_t done = 0; erased && done < n; ) {
+		size_t chunk = static_cast<size_t>(std::min<uint64_t>(n - done, buf.size()));
+		if(op.dtr) {
+			hw.readDtr(buf.data(), chunk, op.dataLanes);
+		} else {
+			hw.readWide(buf.data(), chunk, op.dataLanes);
+		}
+		erased = Blank::isErased(buf.data(), chunk);
+		done += chunk;
+	}
+	hw.stop();
+	return erased && !hw.failed();
+}
+
+//Run the steps of a plan, each with its own timeout. Returns false if the
+//chip did not take one. With a check read, blocks that already read
+//erased are left alone. stoppable false runs the whole plan even after a
+//stop request, for erases whose data is programmed back straight after
+static bool s25_runErase(const Device &dev, FlashInterface &hw,
+                         AddressMode &addrMode, const ErasePlan::Plan &plan,
+                         const ReadOp *check = nullptr, bool stoppable = true) {
+	size_t skipped = 0;
+	for(const ErasePlan::Step &step : plan.steps) {
+		if((stoppable && stopRequested()) || !addrMode.select(step.addr)) return false;
+		if(check && s25_isErased(hw, *check, step.addr, step.bytes)) {
+			skipped++;
+			continue;
+		}
+		if(hw.failed()) {
+			std::cerr << "Error: Blank check read failed at 0x" << std::hex
+			          << step.addr << std::dec << std::endl;
+			return false;
+		}
+		s25_command(hw, Cmd::S25::WRITE_ENABLE);
+		hw.start();
+		s25_cmdAddr(hw, addrMode.command(step.cmd), step.addr, addrMode.addrBytes());
+		hw.stop();
+		if(!s25_waitBusy(hw, s25_eraseUs(dev, step.bytes), stoppable)) return false;
+	}
+	if(check) {
+		std::cout << "Skipped " << skipped << " of " << plan.steps.size()
+		          << " blocks, already erased\n";
+	}
+	return true;
+}
+
+//Erase a plan and program data, plan.end - plan.start bytes, back over it.
+//Data that is only being moved through an erase must not be lost to a
+//stop request, so once the first block is erased the erases and programs
+//run to the end, and only a failed step stops them, naming the range that
+//was left erased. Blank pages are not programmed
+static bool s25_eraseProgram(const Device &dev, FlashInterface &hw,
+                             AddressMode &addrMode, const ErasePlan::Plan &plan,
+                             const unsigned char *data) {
+	const unsigned int pageSize = s25_pageSize(dev);
+	const size_t bytes = static_cast<size_t>(plan.end - plan.start);
+	bool ok = s25_runErase(dev, hw, addrMode, plan, nullptr, false);
+	for(size_t at = 0; ok && at < bytes; at += pageSize) {
+		const size_t n = std::min<size_t>(pageSize, bytes - at);
+		if(Blank::isErased(data + at, n)) continue;
+		ok = s25_program(dev, hw, addrMode, plan.start + at, data + at, n, false);
+	}
+	if(!ok) {
+		std::cerr << "Error: 0x" << std::hex << plan.start << "-0x" << plan.end
+		          << std::dec << " may be left erased, its contents were not "
+		          << "all programmed back" << std::endl;
+	}
+	return ok;
+}
+
+/*** Chip identification *****************************************************/
+//Look dev.jedecId up in the chip database
+static void s25_identify(Device &dev) {
+	dev.chip = nullptr;
+	if(!dev.jedecValid) return;
+	dev.chip = ChipDb::find(dev.jedecId.manufacturer, dev.jedecId.memoryType,
+	                        dev.jedecId.capacity);
+	if(dev.chip) std::cout << "Chip: " << dev.chip->name << "\n";
+}
+
+//With auto speed, run the interface as fast as it goes up to the part's
+//rating: Read (0x03) when that is the dump command, otherwise the fast reads,
+//which program and erase are rated at too. Unknown parts get
+//Limits::AUTO_UNKNOWN_KHZ
+static void s25_autoSpeed(const Device &dev, FlashInterface &hw) {
+	if(dev.KHz >= 0) return;
+	
+	unsigned int limitKHz = Limits::AUTO_UNKNOWN_KHZ;
+	if(dev.chip) {
+		limitKHz = 1000u * ((dev.readCmd == Cmd::S25::READ) ? dev.chip->readMHz
+		                                                   : dev.chip->fastMHz);
+	}
+	
+	hwSpidev *spidev = dynamic_cast<hwSpidev*>(&hw);
+	if(spidev) {
+		unsigned int KHz = std::min<unsigned int>(limitKHz, Limits::SPIDEV_MAX_KHZ);
+		if(spidev->setSpeed(KHz * 1000)) {
+			std::cout << "Auto speed: " << KHz << " KHz\n";
+		}
+		return;
+	}
+	
+	hwSPI *spi = dynamic_cast<hwSPI*>(&hw);
+	if(spi) {
+		spi->setTiming(0);
+		if(spi->achievedKHz() > limitKHz) spi->setTiming(limitKHz);
+		std::cout << "Auto speed: limit " << limitKHz << " KHz\n";
+	}
+}
+
+bool initRead(Device &dev, FlashInterface &hw) {
+	hwSPI *spi = dynamic_cast<hwSPI*>(&hw);
+	if (spi)
+		spi->setTiming(s25_openKHz(dev));
+	dev.jedecValid = hw.readId(dev.jedecId);
+	s25_readCaps(hw, dev.caps);
+	s25_identify(dev);
+	s25_autoSpeed(dev, hw);
+	
+	if(dev.bytes == 0) {
+		const uint64_t chipBytes = s25_chipBytes(dev);
+		if(chipBytes == 0 || dev.offset >= chipBytes) {
+			std::cerr << "Error: The chip size is not known, give it with -b"
+			          << std::endl;
+			return false;
+		}
+		dev.bytes = chipBytes - dev.offset;
+	}
+	return true;
+}
+
+void initWrite(Device &dev, FlashInterface &hw) {
+	hwSPI *spi = dynamic_cast<hwSPI*>(&hw);
+	if (spi)
+		spi->setWriteProtect(false);
+	dev.jedecValid = hw.readId(dev.jedecId);
+	s25_readCaps(hw, dev.caps);
+	s25_identify(dev);
+	s25_autoSpeed(dev, hw);
+	
+	//SST26 parts that power up with every block protected. UNLOCK_SR parts
+	//are unlocked by StatusUnlock for the length of the operation
+	if(dev.chip && dev.chip->has(ChipDb::Quirk::UNLOCK_ULBPR)) {
+		s25_command(hw, Cmd::S25::WRITE_ENABLE);
+		s25_command(hw, Cmd::S25::GLOBAL_UNLOCK);
+	}
+}
+
+bool readJedecId(Device &dev) {
+	if (!isSupported(dev)) return false;
+	std::unique_ptr<FlashInterface> hw = openInterface(dev);
+	if(!hw) return false;
+	dev.jedecValid = hw->readId(dev.jedecId);
+	s25_readCaps(*hw, dev.caps);
+	if(dev.jedecValid) {
+		dev.chip = ChipDb::find(dev.jedecId.manufacturer, dev.jedecId.memoryType,
+		                        dev.jedecId.capacity);
+	}
+	return dev.jedecValid;
+}
+
+void dumpFlashToFile(Device &dev, BinFile &file) {
+	if (!isSupported(dev)) {
+		std::cerr << "Dump only supported for SPI/spidev/wave/DSPI/QSPI 25-series. I2C not yet implemented." << std::endl;
+		return;
+	}
+	
+	std::unique_ptr<FlashInterface> hw = openInterface(dev);
+	if(!hw) return;
+	FlashInterface &dut = *hw;
+	
+	std::cout << "\n";
+	if(!initRead(dev, dut)) return;
+	
+	//The size may have come from the chip, so this waits for initRead
+	std::cout << "Reading " << dev.bytes << " bytes from offset " << dev.offset
+	          << ", at " << s25_speedString(dev) << " to " << file.getFilename()
+	          << "\n\n" << std::flush;
+	
+	hwSPI *spi = dynamic_cast<hwSPI*>(&dut);
+	if (spi) std::cout << "Clock measured at " << spi->achievedKHz() << " KHz\n\n";
+	if (dev.caps.valid) std::cout << dev.caps.describe() << "\n\n";
+	
+	//Clock the read command and overruns are judged by
+	const unsigned int clockKHz = dut.clockKHz();
+	
+	//Declared before the QE guard, so QE is restored first and the chip
+	//leaves 4-byte addressing last
+	AddressMode addrMode(dut, dev, dev.offset + dev.bytes);
+	if(!addrMode.valid()) return;
+	
+	ReadOp op = s25_selectRead(dev, dut, clockKHz);
+	addrMode.apply(op);
+	std::cout << "Read command 0x" << std::hex << (int)op.cmd << std::dec
+	          << (op.dtr ? " (DTR)" : "") << ", " << op.dummyCycles
+	          << " dummy cycles\n\n";
+	//A byte takes 8 / dataLanes clocks, half that with data on both edges
+	Realtime::OverrunCounter overrun(clockKHz, (8 / op.dataLanes) / (op.dtr ? 2 : 1));
+	if(op.dtr && dev.chip && !dev.chip->has(ChipDb::Quirk::DTR)) {
+		std::cout << "Warning: " << dev.chip->name << " is not listed as "
+		          << "supporting DTR reads\n\n";
+	}
+	
+	//Quad reads set QE for the dump, it is restored when this returns
+	std::unique_ptr<QuadEnable> quad;
+	if(op.dataLanes == 4 || op.addrLanes == 4) {
+		ChipId id = dev.jedecValid ? dev.jedecId : ChipId{0, 0, 0};
+		quad.reset(new QuadEnable(dut, id, s25_qeFor(dev), s25_idleUs(dev)));
+		if(!quad->valid()) return;
+	}
+	
+	//In realtime mode progress is printed by its own thread, started before
+	//the switch so it stays an ordinary thread
+	std::unique_ptr<Realtime::Progress> progress;
+	if(dev.realtime) {
+		progress.reset(new Realtime::Progress("Dumped"));
+		file.prefault();
+		Realtime::enter(dev.realtimeCpu);
+	}
+	
+	//Read in chunks, one bulk call and one array push per chunk. One read
+	//command covers the dump, or each bank in bank register mode
+	std::vector<unsigned char> buf(dut.preferredChunk());
+	uint64_t done = 0;
+	while(done < dev.bytes) {
+		const uint64_t addr = dev.offset + done;
+		const uint64_t spanBytes = std::min(addrMode.spanEnd(addr) - addr,
+		                                    dev.bytes - done);
+		
+		bool selected = addrMode.select(addr);
+		dut.start();
+		if(!selected || !dut.beginRead(op, addr)) {
+			dut.stop();
+			if(dev.realtime) Realtime::leave();
+			return;
+		}
+		
+		for(uint64_t spanDone = 0; spanDone < spanBytes; ) {
+			size_t chunk = static_cast<size_t>(std::min<uint64_t>(spanBytes - spanDone,
+			                                                      buf.size()));
+			
+			overrun.begin();
+			if(op.dtr) {
+				dut.readDtr(buf.data(), chunk, op.dataLanes);
+			} else {
+				dut.readWide(buf.data(), chunk, op.dataLanes);
+			}
+			overrun.end(chunk);
+			if(stopRequested()) {
+				dut.stop();
+				if(dev.realtime) Realtime::leave();
+				return;
+			}
+			if(dut.failed()) {
+				dut.stop();
+				if(dev.realtime) Realtime::leave();
+				std::cerr << "\nError: Read failed at offset " << addr + spanDone
+				          << ", the dump is incomplete" << std::endl;
+				return;
+			}
+			file.pushBytesToArray(reinterpret_cast<const char *>(buf.data()), chunk);
+			
+			spanDone += chunk;
+			done += chunk;
+			if(progress) {
+				progress->update(done);
+			} else {
+				std::cout << "\rDumped " << done / 1024 << "KiB" << std::flush;
+			}
+		}
+		dut.stop();
+	}
+	
+	if(dev.realtime) {
+		Realtime::leave();
+		progress->stop();
+	}
+	
+	std::cout << "\n\nFinished dumping to " << file.getFilename() << std::endl;
+	if(overrun.chunks() != 0) {
+		std::cout << "Timing overruns: " << overrun.overruns() << " of "
+		          << overrun.chunks() << " chunks";
+		if(overrun.overruns() != 0) {
+			std::cout << ", worst " << overrun.worstUs() << "us over budget";
+		}
+		std::cout << std::endl;
+	}
+}
+
+//Size of the smallest erase, the unit --diff and manifests work in
+static uint32_t s25_eraseUnit(const Device &dev) {
+	const std::vector<ErasePlan::Type> types = s25_eraseTypes(dev);
+	uint32_t unit = types[0].bytes;
+	for(const ErasePlan::Type &t : types) unit = std::min(unit, t.bytes);
+	return unit;
+}
+
+//Program the image a page at a time. Pages of 0xFF program nothing, they
+//are passed over rather than sent
+static bool s25_writePages(const Device &dev, FlashInterface &hw,
+                           AddressMode &addrMode, BinFile &file) {
+	uint64_t addr = dev.offset;
+	uint64_t remaining = dev.bytes;
+	uint64_t KiBDone = 0;
+	//A program wraps within its page, so chunks stop at each page boundary
+	//when the offset is not aligned
+	const unsigned int pageSize = s25_pageSize(dev);
+	std::vector<unsigned char> page(pageSize);
+	uint64_t pages = 0, blankPages = 0;
+	while (remaining > 0) {
+		unsigned int chunk = static_cast<unsigned int>(std::min<uint64_t>(remaining,
+		                     pageSize - addr % pageSize));
+		size_t got = file.pullBytesFromFile(reinterpret_cast<char *>(page.data()), chunk);
+		if (got == 0) break;
+		if (stopRequested()) return false;
+		pages++;
+		if (Blank::isErased(page.data(), got)) {
+			blankPages++;
+		} else if (!s25_program(dev, hw, addrMode, addr, page.data(), got)) {
+			return false;
+		}
+		addr += chunk;
+		remaining -= chunk;
+		if ((dev.bytes - remaining) / 1024 > KiBDone) {
+			KiBDone = (dev.bytes - remaining) / 1024;
+			std::cout << "\rWritten " << KiBDone << " KiB" << std::flush;
+		}
+	}
+	std::cout << "\n\nFinished writing to flash, " << blankPages << " of " << pages
+	          << " pages were blank and skipped." << std::endl;
+	return true;
+}
+
+//Write the image up to end as a difference from the chip, in erase units.
+//Without changed, each unit is read with op and compared with the image.
+//With it, changed[i] says whether unit i differs, and only changed units
+//that are partly outside the range are read. Units that differ are erased
+//and programmed, blank pages left out. Neighbouring ones are erased
+//together, up to Limits::DIFF_RUN_BYTES, so the plan can use larger blocks.
+//Bytes of a unit outside the range are written back as read
+static bool s25_writeDiff(const Device &dev, FlashInterface &hw,
+                          AddressMode &addrMode, const ReadOp &op, BinFile &file,
+                          uint64_t end, const std::vector<bool> *changed) {
+	const std::vector<ErasePlan::Type> types = s25_eraseTypes(dev);
+	const uint32_t unit = s25_eraseUnit(dev);
+	
+	//Erase the changed units held in run, then program them back. The run
+	//is whole units, so the plan covers exactly it
+	std::vector<unsigned char> run;
+	uint64_t runStart = 0;
+	auto flush = [&]() -> bool {
+		if(run.empty()) return true;
+		ErasePlan::Plan plan = ErasePlan::plan(types, runStart, runStart + run.size());
+		if(!s25_eraseProgram(dev, hw, addrMode, plan, run.data())) return false;
+		run.clear();
+		return true;
+	};
+	
+	std::vector<unsigned char> chip(unit), image(unit);
+	uint64_t units = 0, differing = 0;
+	bool fileEnded = false;
+	for(uint64_t addr = dev.offset - dev.offset % unit; addr < end && !fileEnded; addr += unit) {
+		const uint64_t from = std::max(addr, dev.offset);
+		const size_t want = static_cast<size_t>(std::min(addr + unit, end) - from);
+		const bool partial = from != addr || want != unit;
+		if(stopRequested()) return false;
+		const bool known = changed != nullptr;
+		const bool readChip = !known || ((*changed)[units] && partial);
+		if(readChip) {
+			if(!addrMode.select(addr) || !s25_readSpan(hw, op, addr, chip.data(), unit)) return false;
+			image = chip;
+		}
+		
+		//The image over the chip's contents, a short file leaves the rest
+		const size_t at = static_cast<size_t>(from - addr);
+		size_t got = file.pullBytesFromFile(reinterpret_cast<char *>(image.data() + at), want);
+		if(got < want) {
+			fileEnded = true;
+			//A changed unit the file ends in keeps the chip's bytes after it,
+			//not what the previous unit left in image
+			if(!readChip && (*changed)[units]) {
+				if(!addrMode.select(addr) || !s25_readSpan(hw, op, addr, chip.data(), unit)) return false;
+				memcpy(image.data() + at + got, chip.data() + at + got, unit - at - got);
+			}
+		}
+		
+		const bool differs = known ? (*changed)[units]
+		                           : memcmp(image.data(), chip.data(), unit) != 0;
+		units++;
+		if(!differs) {
+			if(!flush()) return false;
+		} else {
+			differing++;
+			if(run.empty()) runStart = addr;
+			run.insert(run.end(), image.begin(), image.end());
+			if(run.size() >= Limits::DIFF_RUN_BYTES && !flush()) return false;
+		}
+		std::cout << "\r" << (known ? "Checked " : "Compared ") << units * unit / 1024
+		          << " KiB, " << differing << " units differ" << std::flush;
+	}
+	if(!flush()) return false;
+	
+	std::cout << "\n\nFinished writing to flash, " << differing << " of " << units
+	          << " " << unit / 1024 << " KiB units differed." << std::endl;
+	return true;
+}
+
+//Unique ID (0x4B): four dummy bytes, then 8 bytes of ID, as hex. Parts
+//without one read all 0xFF or all 0x00, which gives an empty string
+static std::string s25_readUniqueId(FlashInterface &hw) {
+	const unsigned char cmd = Cmd::S25::READ_UNIQUE_ID;
+	unsigned char id[Limits::S25_UNIQUE_ID_BYTES];
+	hw.start();
+	hw.write(&cmd, 1);
+	hw.dummy(32);
+	hw.read(id, sizeof(id));
+	hw.stop();
+	
+	if(std::all_of(id, id + sizeof(id), [](unsigned char b) { return b == 0xFF; }) ||
+	   std::all_of(id, id + sizeof(id), [](unsigned char b) { return b == 0x00; })) {
+		return "";
+	}
+	std::ostringstream hex;
+	hex << std::hex << std::setfill('0');
+	for(unsigned char b : id) hex << std::setw(2) << (int)b;
+	return hex.str();
+}
+
+static std::string s25_jedecHex(const Device &dev) {
+	if(!dev.jedecValid) return "-";
+	std::ostringstream hex;
+	hex << std::hex << std::setfill('0') << std::setw(2) << (int)dev.jedecId.manufacturer
+	    << std::setw(2) << (int)dev.jedecId.memoryType << std::setw(2)
+	    << (int)dev.jedecId.capacity;
+	return hex.str();
+}
+
+//True if the image can be written against the previous manifest: the same
+//chip, and units laid out the same way
+static bool s25_matchManifest(const Manifest &previous, const Manifest &image) {
+	if(previous.jedec != image.jedec ||
+	   (!previous.uid.empty() && previous.uid != image.uid)) {
+		std::cerr << "Error: The manifest is for chip " << previous.jedec
+		          << (previous.uid.empty() ? "" : " " + previous.uid)
+		          << ", this is " << image.jedec
+		          << (image.uid.empty() ? "" : " " + image.uid) << std::endl;
+		return false;
+	}
+	if(previous.offset != image.offset || previous.unit != image.unit) {
+		std::cerr << "Error: The manifest is for offset " << previous.offset << " in "
+		          << previous.unit << " byte units, this write is offset "
+		          << image.offset << " in " << image.unit << " byte units" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//Write the units of image whose hash differs from previous. First up to
+//dev.sampleUnits of the unchanged ones, picked at random, are read back to
+//confirm the chip still holds what the manifest says
+static bool s25_writeChanged(const Device &dev, FlashInterface &hw,
+                             AddressMode &addrMode, const ReadOp &op, BinFile &file,
+                             const Manifest &previous, const Manifest &image) {
+	std::vector<bool> changed(image.hashes.size());
+	std::vector<size_t> same;
+	for(size_t i = 0; i < image.hashes.size(); i++) {
+		changed[i] = i >= previous.hashes.size() || previous.hashes[i] != image.hashes[i];
+		if(!changed[i]) same.push_back(i);
+	}
+	std::cout << changed.size() - same.size() << " of " << changed.size()
+	          << " units changed since the manifest\n";
+	
+	std::mt19937 rng{std::random_device{}()};
+	std::shuffle(same.begin(), same.end(), rng);
+	if(same.size() > dev.sampleUnits) same.resize(dev.sampleUnits);
+	
+	const uint64_t end = image.offset + image.bytes;
+	std::vector<unsigned char> want(image.unit), got(image.unit);
+	for(size_t i : same) {
+		if(stopRequested()) return false;
+		const uint64_t from = std::max(image.unitStart(i), image.offset);
+		const size_t n = static_cast<size_t>(std::min(image.unitStart(i) + image.unit, end) - from);
+		file.seekRead(from - image.offset);
+		file.pullBytesFromFile(reinterpret_cast<char *>(want.data()), n);
+		if(!addrMode.select(from) || !s25_readSpan(hw, op, from, got.data(), n)) return false;
+		if(memcmp(want.data(), got.data(), n) != 0) {
+			std::cerr << "Error: The chip does not match the manifest at 0x" << std::hex
+			          << from << std::dec << ", write it with --diff instead" << std::endl;
+			return false;
+		}
+	}
+	if(!same.empty()) std::cout << "Checked " << same.size() << " unchanged units against the chip\n";
+	
+	file.seekRead(0);
+	return s25_writeDiff(dev, hw, addrMode, op, file, end, &changed);
+}
+
+void writeFileToFlash(Device &dev, BinFile &file) {
+	if (!isSupported(dev)) {
+		std::cerr << "Write only supported for SPI/spidev/wave/DSPI/QSPI 25-series. I2C not yet implemented." << std::endl;
+		return;
+	}
+	if (!file.isReadMode()) {
+		std::cerr << "Write requires a file opened for reading." << std::endl;
+		return;
+	}
+	std::cout << "\nWriting " << dev.bytes << " bytes from " << file.getFilename()
+	          << " to flash at offset " << dev.offset << "\n\n" << std::flush;
+	Manifest previous, image;
+	if(!dev.manifest.empty() && !previous.load(dev.manifest)) return;
+	std::unique_ptr<FlashInterface> hw = openInterface(dev);
+	if(!hw) return;
+	FlashInterface &dut = *hw;
+	initWrite(dev, dut);
+	StatusUnlock unlock(dut, dev);
+	
+	//Hash the image against the chip's IDs, read before QPI mode
+	if(!dev.manifest.empty() || !dev.saveManifest.empty()) {
+		image.jedec = s25_jedecHex(dev);
+		image.uid = s25_readUniqueId(dut);
+		image.hashImage(file, dev.offset, dev.bytes, s25_eraseUnit(dev));
+		file.seekRead(0);
+		if(!dev.manifest.empty() && !s25_matchManifest(previous, image)) return;
+	}
+	
+	std::unique_ptr<QpiSession> qpi;
+	if(!s25_openQpi(dev, dut, qpi)) return;
+	AddressMode addrMode(dut, dev, dev.offset + dev.bytes);
+	if(!addrMode.valid()) return;
+	
+	bool written;
+	if(dev.diff || !dev.manifest.empty()) {
+		ReadOp op;
+		std::unique_ptr<QuadEnable> quad;
+		if(!s25_checkRead(dev, dut, addrMode, dev.diff ? "--diff" : "--manifest", op, quad)) return;
+		written = dev.diff ? s25_writeDiff(dev, dut, addrMode, op, file, dev.offset + dev.bytes, nullptr)
+		                   : s25_writeChanged(dev, dut, addrMode, op, file, previous, image);
+	} else {
+		written = s25_writePages(dev, dut, addrMode, file);
+	}
+	
+	if(written && !dev.saveManifest.empty() && image.save(dev.saveManifest)) {
+		std::cout << "Manifest saved to " << dev.saveManifest << std::endl;
+	}
+}
+
+//Output name with tag before the extension: out.bin, ".chip0" -> out.chip0.bin
+static std::string taggedFilename(const std::string &filename, const std::string &tag) {
+	size_t dot = filename.find_last_of('.');
+	size_t slash = filename.find_last_of('/');
+	if(dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+		return filename + tag;
+	}
+	return filename.substr(0, dot) + tag + filename.substr(dot);
+}
+
+//Per-chip output name, the chip number goes before the extension:
+//out.bin -> out.chip0.bin
+static std::string chipFilename(const std::string &filename, size_t chip) {
+	return taggedFilename(filename, ".chip" + std::to_string(chip));
+}
+
+void dumpMultiToFiles(Device &dev, const std::string &filename) {
+	if (dev.interface != IFACE::SPI || dev.protocol != PROT::S25) {
+		std::cerr << "Multi-chip dump only supported for SPI 25-series." << std::endl;
+		return;
+	}
+	
+	const size_t chips = dev.misoPins.size();
+	std::unique_ptr<hwSPI> dut = openSPI(dev);
+	if(!dut) return;
+	dut->setMisoPins(dev.misoPins);
+	
+	//The IDs of every chip come back in one go too, they should all match
+	std::vector<unsigned char> buf(chips * Limits::XFER_CHUNK);
+	std::vector<unsigned char *> outs(chips);
+	for(size_t c = 0; c < chips; c++) outs[c] = buf.data() + c * Limits::XFER_CHUNK;
+	
+	const unsigned char idCmd = Cmd::S25::READ_JEDEC_ID;
+	dut->start();
+	dut->write(&idCmd, 1);
+	dut->readMulti(outs.data(), 3);
+	dut->stop();
+	std::cout << "\n";
+	for(size_t c = 0; c < chips; c++) {
+		std::cout << "Chip " << c << " (GPIO " << dev.misoPins[c] << ") JEDEC ID: "
+		          << std::hex << "0x" << (int)outs[c][0] << " 0x" << (int)outs[c][1]
+		          << " 0x" << (int)outs[c][2] << std::dec;
+		if(c != 0 && memcmp(outs[c], outs[0], 3) != 0) std::cout << " (differs)";
+		std::cout << "\n";
+	}
+	
+	//Speed and size go by the first chip. SFDP is not read, its reads are
+	//single chip
+	dev.jedecId = ChipId{outs[0][0], outs[0][1], outs[0][2]};
+	dev.jedecValid = true;
+	s25_identify(dev);
+	s25_autoSpeed(dev, *dut);
+	if(dev.bytes == 0) {
+		if(dev.chip == nullptr || dev.offset >= dev.chip->bytes) {
+			std::cerr << "Error: The chip size is not known, give it with -b"
+			          << std::endl;
+			return;
+		}
+		dev.bytes = dev.chip->bytes - dev.offset;
+	}
+	
+	//One file per chip, with a smaller array each as there may be dozens
+	std::vector<std::unique_ptr<BinFile>> files;
+	for(size_t c = 0; c < chips; c++) {
+		std::string name = chipFilename(filename, c);
+		files.emplace_back(new BinFile(name.c_str(), 'w', 1048576));
+	}
+	
+	std::cout << "\nReading " << dev.bytes << " bytes from offset " << dev.offset
+	          << " of " << chips << " chips, at " << s25_speedString(dev) << "\n"
+	          << "Clock measured at " << dut->achievedKHz() << " KHz\n\n"
+	          << std::flush;
+	
+	//Chips are sampled from one level snapshot per clock, single edge only
+	ReadOp op = s25_selectRead(dev, *dut, dut->achievedKHz());
+	if(op.dtr) {
+		std::cerr << "Error: DTR reads are not supported with multiple chips"
+		          << std::endl;
+		return;
+	}
+	
+	AddressMode addrMode(*dut, dev, dev.offset + dev.bytes);
+	if(!addrMode.valid()) return;
+	addrMode.apply(op);
+	
+	std::unique_ptr<Realtime::Progress> progress;
+	if(dev.realtime) {
+		progress.reset(new Realtime::Progress("Dumped", " per chip"));
+		for(std::unique_ptr<BinFile> &f : files) f->prefault();
+		Realtime::enter(dev.realtimeCpu);
+	}
+	
+	std::vector<Crc32> crcs(chips);
+	uint64_t done = 0;
+	while(done < dev.bytes) {
+		const uint64_t addr = dev.offset + done;
+		const uint64_t spanBytes = std::min(addrMode.spanEnd(addr) - addr,
+		                                    dev.bytes - done);
+		
+		bool selected = addrMode.select(addr);
+		dut->start();
+		if(!selected || !dut->beginRead(op, addr)) {
+			dut->stop();
+			if(dev.realtime) Realtime::leave();
+			return;
+		}
+		
+		for(uint64_t spanDone = 0; spanDone < spanBytes; ) {
+			size_t chunk = static_cast<size_t>(std::min<uint64_t>(spanBytes - spanDone,
+			                                                      Limits::XFER_CHUNK));
+			
+			dut->readMulti(outs.data(), chunk);
+			if(stopRequested()) {
+				dut->stop();
+				if(dev.realtime) Realtime::leave();
+				return;
+			}
+			for(size_t c = 0; c < chips; c++) {
+				files[c]->pushBytesToArray(reinterpret_cast<const char *>(outs[c]), chunk);
+				crcs[c].update(outs[c], chunk);
+			}
+			
+			spanDone += chunk;
+			done += chunk;
+			if(progress) {
+				progress->update(done);
+			} else {
+				std::cout << "\rDumped " << done / 1024 << "KiB per chip" << std::flush;
+			}
+		}
+		dut->stop();
+	}
+	
+	if(dev.realtime) {
+		Realtime::leave();
+		progress->stop();
+	}
+	
+	std::cout << "\n\n";
+	for(size_t c = 0; c < chips; c++) {
+		std::cout << files[c]->getFilename() << "  CRC-32 0x" << std::hex
+		          << std::setw(8) << std::setfill('0') << crcs[c].value()
+		          << std::setfill(' ') << std::dec << "\n";
+	}
+	std::cout << "\nFinished dumping " << chips << " chips" << std::endl;
+}
+
+void dumpRanges(Device &dev, std::vector<Ranges::Range> ranges, uint64_t gap,
+                const std::string &filename, bool split) {
+	if (!isSupported(dev)) {
+		std::cerr << "Range dump only supported for SPI/spidev/wave/DSPI/QSPI 25-series." << std::endl;
+		return;
+	}
+	if (ranges.empty()) return;
+	
+	const std::vector<Ranges::Read> reads = Ranges::coalesce(ranges, gap);
+	uint64_t total = 0, end = 0;
+	for (const Ranges::Read &read : reads) {
+		total += read.bytes;
+		end = std::max(end, read.end());
+	}
+	if (end > Limits::MAX_BYTES) {
+		std::cerr << "Error: Ranges end at " << end << ", past the 256MiB limit" << std::endl;
+		return;
+	}
+	
+	std::unique_ptr<FlashInterface> hw = openInterface(dev);
+	if(!hw) return;
+	FlashInterface &dut = *hw;
+	
+	//The ranges give the size, initRead must not take it from the chip
+	dev.offset = 0;
+	dev.bytes = end;
+	std::cout << "\n";
+	if(!initRead(dev, dut)) return;
+	
+	std::cout << "Reading " << ranges.size() << " ranges in " << reads.size()
+	          << " reads of " << total << " bytes, at " << s25_speedString(dev)
+	          << "\n\n" << std::flush;
+	
+	hwSPI *spi = dynamic_cast<hwSPI*>(&dut);
+	if (spi) std::cout << "Clock measured at " << spi->achievedKHz() << " KHz\n\n";
+	const unsigned int clockKHz = dut.clockKHz();
+	
+	AddressMode addrMode(dut, dev, end);
+	if(!addrMode.valid()) return;
+	
+	ReadOp op = s25_selectRead(dev, dut, clockKHz, true);
+	addrMode.apply(op);
+	std::cout << "Read command 0x" << std::hex << (int)op.cmd << std::dec
+	          << (op.dtr ? " (DTR)" : "") << ", " << op.dummyCycles
+	          << " dummy cycles" << (op.mode >= 0 ? ", continuous read" : "")
+	          << "\n\n";
+	
+	std::unique_ptr<QuadEnable> quad;
+	if(op.dataLanes == 4 || op.addrLanes == 4) {
+		ChipId id = dev.jedecValid ? dev.jedecId : ChipId{0, 0, 0};
+		quad.reset(new QuadEnable(dut, id, s25_qeFor(dev), s25_idleUs(dev)));
+		if(!quad->valid()) return;
+	}
+	
+	//Declared after the QE and address mode guards, so the chip leaves
+	//continuous read before they send their commands
+	struct ContinuousGuard {
+		FlashInterface &hw;
+		~ContinuousGuard() { hw.endRandomRead(); }
+	} continuousGuard{dut};
+	
+	//One sparse image addressed like the chip, or a file per range named
+	//after its start, out.bin -> out.0x10000.bin
+	std::unique_ptr<BinFile> image;
+	std::vector<std::unique_ptr<BinFile>> parts;
+	if(split) {
+		for(const Ranges::Range &r : ranges) {
+			std::ostringstream tag;
+			tag << ".0x" << std::hex << r.start;
+			std::string name = taggedFilename(filename, tag.str());
+			parts.emplace_back(new BinFile(name.c_str(), 'w', 1048576));
+		}
+	} else {
+		image.reset(new BinFile(filename.c_str(), 'w'));
+	}
+	
+	//Hand a chunk read at addr to the outputs. The image takes the whole
+	//read, gap bytes included, each range file only its own part
+	auto deliver = [&](const Ranges::Read &read, uint64_t addr,
+	                   const unsigned char *data, size_t n) {
+		if(image) {
+			image->pushBytesToArray(reinterpret_cast<const char *>(data), n);
+			return;
+		}
+		for(size_t i : read.parts) {
+			const Ranges::Range &r = ranges[i];
+			uint64_t from = std::max(addr, r.start);
+			uint64_t to = std::min(addr + n, r.end());
+			if(from >= to) continue;
+			parts[i]->pushBytesToArray(reinterpret_cast<const char *>(data + (from - addr)),
+			                           static_cast<size_t>(to - from));
+		}
+	};
+	
+	//A read that fits the buffer is one readAt(), which keeps the chip in
+	//continuous read so the next one skips the opcode. Longer reads, and
+	//bank register mode, stream like a dump with the chip out of it
+	std::vector<unsigned char> buf(dut.preferredChunk());
+	uint64_t done = 0;
+	for(const Ranges::Read &read : reads) {
+		if(stopRequested()) return;
+		if(image) image->seekWrite(read.start);
+		
+		if(read.bytes <= buf.size() && addrMode.spanEnd(read.start) == UINT64_MAX) {
+			if(!dut.readAt(op, read.start, buf.data(), static_cast<size_t>(read.bytes))) {
+				if(dut.failed()) {
+					std::cerr << "\nError: Read failed at 0x" << std::hex << read.start
+					          << std::dec << std::endl;
+				}
+				return;
+			}
+			deliver(read, read.start, buf.data(), static_cast<size_t>(read.bytes));
+			done += read.bytes;
+			std::cout << "\rRead " << done / 1024 << " KiB of " << total / 1024
+			          << " KiB" << std::flush;
+			continue;
+		}
+		
+		dut.endRandomRead();
+		for(uint64_t addr = read.start; addr < read.end(); ) {
+			const uint64_t spanBytes = std::min(addrMode.spanEnd(addr), read.end()) - addr;
+			bool selected = addrMode.select(addr);
+			dut.start();
+			if(!selected || !dut.beginRead(op, addr)) {
+				dut.stop();
+				return;
+			}
+			for(uint64_t spanDone = 0; spanDone < spanBytes; ) {
+				size_t chunk = static_cast<size_t>(std::min<uint64_t>(spanBytes - spanDone,
+				                                                      buf.size()));
+				if(op.dtr) {
+					dut.readDtr(buf.data(), chunk, op.dataLanes);
+				} else {
+					dut.readWide(buf.data(), chunk, op.dataLanes);
+				}
+				if(stopRequested()) {
+					dut.stop();
+					return;
+				}
+				if(dut.failed()) {
+					dut.stop();
+					std::cerr << "\nError: Read failed at 0x" << std::hex
+					          << addr + spanDone << std::dec << std::endl;
+					return;
+				}
+				deliver(read, addr + spanDone, buf.data(), chunk);
+				spanDone += chunk;
+				done += chunk;
+				std::cout << "\rRead " << done / 1024 << " KiB of " << total / 1024
+				          << " KiB" << std::flush;
+			}
+			dut.stop();
+			addr += spanBytes;
+		}
+	}
+	
+	std::cout << "\n\nFinished reading " << ranges.size() << " ranges to "
+	          << (split ? taggedFilename(filename, ".0x*") : filename) << std::endl;
+}
+
+void eraseFlash(Device &dev, uint64_t byteCount) {
+	if (!isSupported(dev)) {
+		std::cerr << "Erase only supported for SPI/spidev/wave/DSPI/QSPI 25-series. I2C not yet implemented." << std::endl;
+		return;
+	}
+	std::unique_ptr<FlashInterface> hw = openInterface(dev);
+	if(!hw) return;
+	FlashInterface &dut = *hw;
+	initWrite(dev, dut);
+	StatusUnlock unlock(dut, dev);
+	std::unique_ptr<QpiSession> qpi;
+	if(!s25_openQpi(dev, dut, qpi)) return;
+	if (byteCount == 0) {
+		// Timed from the chip size, no timeout when it is not known
+		const uint64_t timeoutUs = s25_chipEraseUs(dev);
+		s25_command(dut, Cmd::S25::WRITE_ENABLE);
+		s25_command(dut, Cmd::S25::CHIP_ERASE);
+		std::cout << "Chip erase started (full device)";
+		if (timeoutUs != 0) std::cout << ", allowing up to " << timeoutUs / 1000000 << "s";
+		std::cout << std::endl;
+		if (s25_waitBusy(dut, timeoutUs)) std::cout << "Chip erase finished." << std::endl;
+	} else {
+		// The fewest, largest blocks that cover the range. Blocks are
+		// aligned to their size, so an unaligned range would take data
+		// outside it with it
+		const uint64_t end = dev.offset + byteCount;
+		ErasePlan::Plan plan = ErasePlan::plan(s25_eraseTypes(dev), dev.offset, end);
+		if (!plan.exact(dev.offset, end)) {
+			std::cerr << "Error: The range is not aligned to the chip's erase blocks, "
+			          << "erasing it would also erase bytes " << plan.start << "-"
+			          << plan.end << ". Use -o " << plan.start << " -b "
+			          << plan.end - plan.start << " to erase all of them" << std::endl;
+			return;
+		}
+		s25_printPlan(plan);
+		AddressMode addrMode(dut, dev, end);
+		if (!addrMode.valid()) return;
+		
+		ReadOp check;
+		std::unique_ptr<QuadEnable> quad;
+		if (dev.blankCheck && !s25_checkRead(dev, dut, addrMode, "--blank-check", check, quad)) {
+			return;
+		}
+		if (!s25_runErase(dev, dut, addrMode, plan, dev.blankCheck ? &check : nullptr)) return;
+		std::cout << "Erased " << byteCount << " bytes from offset " << dev.offset << std::endl;
+	}
+}
+
+//One erase unit of the patch cache, as read from the chip and as patched
+struct PatchUnit {
+	std::vector<unsigned char> before;
+	std::vector<unsigned char> after;
+	
+	//Program can only clear bits, setting one takes an erase
+	bool needsErase() const {
+		for(size_t i = 0; i < after.size(); i++) {
+			if((before[i] & after[i]) != after[i]) return true;
+		}
+		return false;
+	}
+};
+
+void patchFlash(Device &dev, const std::vector<Patch::Update> &updates) {
+	if (!isSupported(dev)) {
+		std::cerr << "Patch only supported for SPI/spidev/wave/DSPI/QSPI 25-series. I2C not yet implemented." << std::endl;
+		return;
+	}
+	uint64_t end = 0, bytes = 0;
+	for (const Patch::Update &u : updates) {
+		end = std::max(end, u.end());
+		bytes += u.data.size();
+	}
+	
+	std::unique_ptr<FlashInterface> hw = openInterface(dev);
+	if(!hw) return;
+	FlashInterface &dut = *hw;
+	initWrite(dev, dut);
+	StatusUnlock unlock(dut, dev);
+	const uint64_t chipBytes = s25_chipBytes(dev);
+	if (chipBytes != 0 && end > chipBytes) {
+		std::cerr << "Error: The patch ends at " << end << ", past the end of the "
+		          << chipBytes << " byte chip" << std::endl;
+		return;
+	}
+	AddressMode addrMode(dut, dev, end);
+	if (!addrMode.valid()) return;
+	ReadOp op;
+	std::unique_ptr<QuadEnable> quad;
+	if (!s25_checkRead(dev, dut, addrMode, "--patch", op, quad)) return;
+	
+	//Read every unit an update touches once, then apply the updates in
+	//order, so a later one wins where two overlap
+	const uint32_t unit = s25_eraseUnit(dev);
+	std::map<uint64_t, PatchUnit> cache;
+	for (const Patch::Update &u : updates) {
+		for (uint64_t addr = u.addr - u.addr % unit; addr < u.end(); addr += unit) {
+			if (cache.count(addr) != 0) continue;
+			if (stopRequested()) return;
+			PatchUnit &cached = cache[addr];
+			cached.before.resize(unit);
+			if (!addrMode.select(addr) ||
+			    !s25_readSpan(dut, op, addr, cached.before.data(), unit)) return;
+			cached.after = cached.before;
+		}
+		for (size_t done = 0; done < u.data.size(); ) {
+			const uint64_t addr = u.addr + done;
+			const size_t at = static_cast<size_t>(addr % unit);
+			const size_t n = std::min<size_t>(unit - at, u.data.size() - done);
+			memcpy(cache[addr - at].after.data() + at, u.data.data() + done, n);
+			done += n;
+		}
+	}
+	std::cout << "Patching " << bytes << " bytes in " << updates.size() << " updates, "
+	          << cache.size() << " " << unit / 1024 << " KiB units read\n";
+	
+	//Units programmed over need only the pages that changed
+	const unsigned int pageSize = s25_pageSize(dev);
+	uint64_t pages = 0;
+	auto program = [&](uint64_t addr, const PatchUnit &cached) -> bool {
+		for (size_t at = 0; at < unit; at += pageSize) {
+			const size_t n = std::min<size_t>(pageSize, unit - at);
+			const unsigned char *data = cached.after.data() + at;
+			if (memcmp(data, cached.before.data() + at, n) == 0) continue;
+			if (!s25_program(dev, dut, addrMode, addr + at, data, n)) return false;
+			pages++;
+		}
+		return true;
+	};
+	
+	//Units that need an erase and sit next to each other share a plan. Once
+	//it starts the run is erased and programmed back whole, a stop request
+	//is only taken between runs
+	const std::vector<ErasePlan::Type> types = s25_eraseTypes(dev);
+	std::vector<uint64_t> run;
+	std::vector<unsigned char> runData;
+	uint64_t changed = 0, erased = 0;
+	auto flush = [&]() -> bool {
+		if (run.empty()) return true;
+		ErasePlan::Plan plan = ErasePlan::plan(types, run.front(), run.back() + unit);
+		runData.clear();
+		for (uint64_t addr : run) {
+			const std::vector<unsigned char> &after = cache[addr].after;
+			runData.insert(runData.end(), after.begin(), after.end());
+		}
+		if (!s25_eraseProgram(dev, dut, addrMode, plan, runData.data())) return false;
+		for (size_t at = 0; at < runData.size(); at += pageSize) {
+			const size_t n = std::min<size_t>(pageSize, runData.size() - at);
+			if (!Blank::isErased(runData.data() + at, n)) pages++;
+		}
+		erased += run.size();
+		run.clear();
+		return true;
+	};
+	
+	for (const std::pair<const uint64_t, PatchUnit> &entry : cache) {
+		const uint64_t addr = entry.first;
+		const PatchUnit &cached = entry.second;
+		if (cached.after == cached.before) continue;
+		if (stopRequested()) return;
+		changed++;
+		if (cached.needsErase()) {
+			if (!run.empty() && run.back() + unit != addr && !flush()) return;
+			run.push_back(addr);
+		} else if (!program(addr, cached)) {
+			return;
+		}
+	}
+	if (!flush()) return;
+	
+	//Read the changed units back, a patch is small enough to always check
+	std::vector<unsigned char> check(unit);
+	for (const std::pair<const uint64_t, PatchUnit> &entry : cache) {
+		if (entry.second.after == entry.second.before) continue;
+		if (!addrMode.select(entry.first) ||
+		    !s25_readSpan(dut, op, entry.first, check.data(), unit)) return;
+		if (check != entry.second.after) {
+			std::cerr << "Error: Unit at 0x" << std::hex << entry.first << std::dec
+			          << " did not read back as patched" << std::endl;
+			return;
 		}
-		std::cout << "Erased " << byteCount << " bytes from offset " << dev.offset << std::endl;
 	}
-	dut.stop();
+	std::cout << "Patched " << changed << " of " << cache.size() << " units, "
+	          << erased << " erased, " << pages << " pages programmed, verified."
+	          << std::endl;
 }
 
 }; //namespace splasher
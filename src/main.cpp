@@ -12,6 +12,10 @@
 * 11 Apr 2023
 *******************************************************************************/
 #include <iostream>
+#include <cstdint>
+#include <vector>
+#include <csignal>
+#include <unistd.h>
 
 #include <pigpio.h>
 
@@ -29,40 +33,114 @@ use --help for full help information\n";
 const char *longHelp =
 	"Usage: splasher <file> [options]\n\n"
 	"By default splasher dumps (reads) from the flash chip to the given file.\n"
-	"Requires -b/--bytes for dump and write. Run with sudo (pigpio).\n\n"
+	"Requires -b/--bytes for write. Run with sudo (pigpio).\n\n"
 	"Options:\n"
 	"  -h, --help       Show this help\n"
-	"  -b, --bytes      Bytes to read/write (required for dump/write). Suffixes: K, M (e.g. 16M)\n"
-	"  -s, --speed     SPI speed in KHz (1-1000), or \"max\". Also: --speed=500\n"
+	"  -b, --bytes      Bytes to read/write (required for write). Suffixes: K, M (e.g. 16M)\n"
+	"                   Dumps default to the chip size, from SFDP or the chip list\n"
+	"  -s, --speed     SPI speed in KHz (1-10000, spidev 1-50000), or \"max\".\n"
+	"                   The bit-banged clock is measured and trimmed to match.\n"
+	"                   Default: the chip's rating from the built-in chip list\n"
 	"  -o, --offset     Start address in bytes (default 0). Suffixes: K, M\n"
-	"  --jedec          Read and print JEDEC ID (manufacturer, type, capacity), then exit\n"
+	"  --jedec          Read and print JEDEC ID (manufacturer, type, capacity), the\n"
+	"                   part name and the SFDP parameters, then exit\n"
 	"  -w, --write      Flash (write) file to device; requires -b; -o = start address\n"
-	"  -e, --erase      Erase: full chip, or from -o for -b bytes\n"
-	"  -i, --interface  Interface: spi (default), dspi, qspi, i2c\n\n"
+	"                   Pages that are all 0xFF are skipped\n"
+	"  --diff           With -w, read the chip first and only erase and program\n"
+	"                   the erase blocks that differ from the file\n"
+	"  --save-manifest  With -w, save a hash of each erase block written, with\n"
+	"                   the chip's JEDEC and unique IDs, to this file\n"
+	"  --manifest       With -w, the manifest saved by the last write. Only the\n"
+	"                   blocks whose hash changed are erased and programmed\n"
+	"  --sample         With --manifest, first read back this many unchanged\n"
+	"                   blocks, picked at random, to check the chip (default 0)\n"
+	"  -e, --erase      Erase: full chip, or from -o for -b bytes, which must be\n"
+	"                   aligned to the chip's smallest erase block\n"
+	"  --blank-check    With -e -b, read each block first and only erase the\n"
+	"                   ones with data in them\n"
+	"  -i, --interface  Interface: spi (default), spidev, wave, dspi, qspi, i2c\n"
+	"                   spidev uses the Pi's hardware SPI controller\n"
+	"                   wave clocks SPI from DMA waveforms (max 250KHz)\n"
+	"                   dspi reads 2 bits per clock over MOSI (IO0) and MISO (IO1)\n"
+	"                   qspi reads 4, adding WP (IO2) and HOLD (IO3)\n"
+	"  --spidev         spidev device node (default /dev/spidev0.0)\n"
+	"  -g, --gpio       GPIO driver: pigpio (default), or gpiomem for direct\n"
+	"                   register access through /dev/gpiomem (faster)\n"
+	"  -m, --multi      Dump several chips at once: comma separated MISO GPIOs,\n"
+	"                   one per chip, sharing SCLK, MOSI and CS. Writes one\n"
+	"                   file per chip (out.bin -> out.chip0.bin, ...)\n"
+	"  --realtime       Dump with the transfer thread pinned to the given CPU,\n"
+	"                   SCHED_FIFO and memory locked. Reports timing overruns\n"
+	"  --read-cmd       Dump read command: read (0x03), fast (0x0B), dual (0x3B),\n"
+	"                   dualio (0xBB), quad (0x6B), quadio (0xEB), dtr (0x0D),\n"
+	"                   dtrdual (0xBD), dtrquad (0xED) or auto\n"
+	"                   (default: quad on qspi, dual on dspi, otherwise fast\n"
+	"                   above 33MHz where 0x03 is out of spec)\n"
+	"  --dummy          Dummy clock cycles after the read address (fast: 8)\n"
+	"  --qpi            With -i qspi, write and erase in QPI (4-4-4) mode\n"
+	"  --addr-mode      Addressing above 16MiB: 4byte opcodes (0x13, 0x12, 0x21..),\n"
+	"                   enter (0xB7/0xE9), bank (register 0xC5), 3byte, or auto\n"
+	"                   (default: 4byte when the access ends above 16MiB)\n"
+	"  --ranges         Dump only these ranges in one session, comma separated\n"
+	"                   START+LENGTH or START-END, decimal or 0x hex, K/M\n"
+	"                   suffixes. Written at their addresses in a sparse file\n"
+	"  --gap            Ranges this close share one read command (default 4K)\n"
+	"  --split          With --ranges, one file per range (out.0x10000.bin)\n"
+	"  --patch          Change bytes in place, keeping the rest of the chip:\n"
+	"                   comma separated ADDR=HEX (':' separators allowed), or a\n"
+	"                   bare ADDR for the whole file. Only the erase blocks\n"
+	"                   touched are read, erased if needed and written back\n\n"
 	"Examples:\n"
+	"  splasher output.bin\n"
 	"  splasher output.bin -b 16M\n"
+	"  splasher output.bin -b 16M -s max -g gpiomem\n"
 	"  splasher out.bin -b 16M -s 500 -o 64K\n"
+	"  splasher out.bin -b 16M -i spidev -s 20000\n"
+	"  splasher out.bin -b 16M -m 3,5,6,13 -g gpiomem\n"
+	"  splasher out.bin -b 16M -s max -g gpiomem --realtime 3\n"
+	"  splasher out.bin -b 16M -i spidev -s 50000 --read-cmd fast --dummy 8\n"
+	"  splasher out.bin -b 16M -i dspi -s max -g gpiomem --read-cmd dualio\n"
+	"  splasher out.bin -b 16M -i qspi -s 20000 --read-cmd dtrquad --dummy 8\n"
+	"  splasher out.bin -b 16M -i qspi -s max -g gpiomem\n"
+	"  splasher firmware.bin -b 256K -w -i qspi --qpi\n"
+	"  splasher out.bin -b 64M -s max -g gpiomem --addr-mode enter\n"
+	"  splasher boot.bin --ranges 0+64K,0x3F0000+4K,0x3FF000-4M\n"
+	"  splasher parts.bin --ranges 0+64K,0x10000+4K --split -i qspi -s max\n"
+	"  splasher /dev/null --patch 0x3FF000=00:16:3e:5a:1b:2c\n"
+	"  splasher env.bin --patch 0x3F800\n"
 	"  splasher --jedec\n"
 	"  splasher firmware.bin -b 256K -w\n"
+	"  splasher firmware.bin -b 4M -w --diff -i qspi -s max\n"
+	"  splasher v2.bin -b 4M -w --manifest v1.mf --save-manifest v2.mf --sample 8\n"
 	"  splasher /dev/null -e\n"
+	"  splasher /dev/null -b 1M -e --blank-check\n"
 	"  splasher /dev/null -b 64K -o 0 -e\n";
 
 
 const char *speedNotValid = "Speed (in KHz) input is invalid\n";
-const char *speedTooHigh = "Speed (in KHz) is too high, Maximum is 1000KHz\n";
-const char *speedDefault = "Speed not specified, using default of 100KHz\n";
+const char *speedTooHigh = "Speed (in KHz) is too high, Maximum is ";
+const char *speedDefault = "Speed not specified, using the chip's rated speed\n";
 
 const char *bytesNotValid = "Bytes argument input is invalid. valid input e.g. \
 -b 100    -b 100K    -b 2M\n";
 const char *bytesNotSpecified = "Bytes to read has not been specified\n";
 const char *bytesTooLarge = "Bytes is too large, byte limit is 256MiB\n";
 const char *offsetNotValid = "Offset argument invalid. e.g. -o 0  -o 64K  -o 1M\n";
+const char *gpioNotValid = "GPIO driver is invalid. Use pigpio or gpiomem\n";
+const char *multiNotValid = "Multi-chip MISO list is invalid. e.g. -m 3,5,6,13 \
+(GPIO 0-27, not SCLK, MOSI, CS or WP)\n";
+const char *cpuNotValid = "Realtime CPU is invalid. e.g. --realtime 3\n";
+const char *readCmdNotValid = "Read command is invalid. Use read, fast, dual, dualio, quad, quadio, dtr, dtrdual, dtrquad or auto\n";
+const char *addrModeNotValid = "Address mode is invalid. Use auto, 3byte, 4byte, enter or bank\n";
+const char *dummyNotValid = "Dummy cycles is invalid, 0-32. e.g. --dummy 8\n";
+const char *gapNotValid = "Gap is invalid. e.g. --gap 4K  --gap 0x100\n";
+const char *sampleNotValid = "Sample count is invalid. e.g. --sample 8\n";
 } //namespace message
 
 /*** Helper functions *********************************************************/
 //converts a string into a KHz value - for user argument handling
 //Negative values are coded errors (-1 not valid   -2 too large input)
-int convertKHz(std::string speedString) {
+int convertKHz(std::string speedString, int maxKHz = Limits::MAX_KHZ) {
 	//First check if the input is "max"
 	if(speedString.compare("max") == 0) {
 		//Unlimit the KHz
@@ -79,8 +157,8 @@ int convertKHz(std::string speedString) {
 	int speedInt = std::stoi(speedString);
 	
 	//Detect if the input value is too high, if so return -2
-	if(speedInt > 1000) {
-		std::cerr << message::speedTooHigh;
+	if(speedInt > maxKHz) {
+		std::cerr << message::speedTooHigh << maxKHz << "KHz\n";
 		return -2;
 	}
 	
@@ -88,7 +166,7 @@ int convertKHz(std::string speedString) {
 	return speedInt;
 }
 
-unsigned long convertBytes(std::string byteString) {
+uint64_t convertBytes(std::string byteString) {
 	//Keep a multiplier, 1 by default for bytes, changes via 'K' or 'M'
 	unsigned int multiplier = 1;
 	
@@ -125,11 +203,18 @@ unsigned long convertBytes(std::string byteString) {
 	}
 	
 	/*** Convert and multiply the input number ********************************/
+	//Anything this long is over the limit, and would overflow the conversion
+	if(byteString.empty() || byteString.length() > 12) {
+		std::cerr << (byteString.empty() ? message::bytesNotValid
+		                                 : message::bytesTooLarge);
+		return 0;
+	}
+	
 	//convert the passed string into an int and set device bytes
-	unsigned long bytes = std::stoi(byteString) * multiplier;
+	uint64_t bytes = std::stoull(byteString) * multiplier;
 	
 	//Make sure the bytes are not too high (Limit to 256MB)
-	if(bytes > 268435456) {
+	if(bytes > Limits::MAX_BYTES) {
 		std::cerr << message::bytesTooLarge;
 		return 0;
 	}
@@ -139,16 +224,152 @@ unsigned long convertBytes(std::string byteString) {
 
 }
 
+//converts a string into a GPIO driver selection. Returns false if invalid
+bool convertGpioDriver(const std::string &drvString, GPIODRV &drv) {
+	if(drvString == "pigpio") {
+		drv = GPIODRV::PIGPIO;
+	} else if(drvString == "gpiomem") {
+		drv = GPIODRV::GPIOMEM;
+	} else {
+		std::cerr << message::gpioNotValid;
+		return false;
+	}
+	return true;
+}
+
+//converts a comma separated list of MISO GPIOs for multi-chip dumps. Returns
+//false if any entry is not a free bank 0 GPIO, or is repeated
+bool convertMisoPins(const std::string &pinString, std::vector<int> &pins) {
+	pins.clear();
+	size_t start = 0;
+	while(start <= pinString.length()) {
+		size_t comma = pinString.find(',', start);
+		if(comma == std::string::npos) comma = pinString.length();
+		std::string entry = pinString.substr(start, comma - start);
+		
+		if(entry.empty() || entry.length() > 2 ||
+		   entry.find_first_not_of("0123456789") != std::string::npos) {
+			std::cerr << message::multiNotValid;
+			return false;
+		}
+		
+		int pin = std::stoi(entry);
+		bool reserved = pin == Pinout::SPI_SCLK || pin == Pinout::SPI_MOSI ||
+		                pin == Pinout::SPI_CS || pin == Pinout::SPI_WP;
+		bool repeated = false;
+		for(int p : pins) if(p == pin) repeated = true;
+		if(pin > 27 || reserved || repeated) {
+			std::cerr << message::multiNotValid;
+			return false;
+		}
+		
+		pins.push_back(pin);
+		start = comma + 1;
+	}
+	return true;
+}
+
+//converts an address mode name. Returns false if invalid
+bool convertAddrMode(const std::string &modeString, ADDRMODE &mode) {
+	if(modeString == "auto") {
+		mode = ADDRMODE::AUTO;
+	} else if(modeString == "3byte") {
+		mode = ADDRMODE::THREE;
+	} else if(modeString == "4byte") {
+		mode = ADDRMODE::OPCODES;
+	} else if(modeString == "enter") {
+		mode = ADDRMODE::ENTER;
+	} else if(modeString == "bank") {
+		mode = ADDRMODE::BANK;
+	} else {
+		std::cerr << message::addrModeNotValid;
+		return false;
+	}
+	return true;
+}
+
+//converts a read command name, auto gives 0 (picked from the clock). Returns
+//false if invalid
+bool convertReadCmd(const std::string &cmdString, unsigned char &cmd) {
+	if(cmdString == "auto") {
+		cmd = 0;
+	} else if(cmdString == "read") {
+		cmd = Cmd::S25::READ;
+	} else if(cmdString == "fast") {
+		cmd = Cmd::S25::FAST_READ;
+	} else if(cmdString == "dual") {
+		cmd = Cmd::S25::DUAL_READ;
+	} else if(cmdString == "dualio") {
+		cmd = Cmd::S25::DUAL_IO_READ;
+	} else if(cmdString == "quad") {
+		cmd = Cmd::S25::QUAD_READ;
+	} else if(cmdString == "quadio") {
+		cmd = Cmd::S25::QUAD_IO_READ;
+	} else if(cmdString == "dtr") {
+		cmd = Cmd::S25::DTR_FAST_READ;
+	} else if(cmdString == "dtrdual") {
+		cmd = Cmd::S25::DTR_DUAL_IO_READ;
+	} else if(cmdString == "dtrquad") {
+		cmd = Cmd::S25::DTR_QUAD_IO_READ;
+	} else {
+		std::cerr << message::readCmdNotValid;
+		return false;
+	}
+	return true;
+}
+
+//converts a string into an interface and its protocol. Returns false if invalid
+bool convertInterface(const std::string &ifaceString, Device &dev) {
+	if (ifaceString == "spi")         { dev.interface = IFACE::SPI;    dev.protocol = PROT::S25; }
+	else if (ifaceString == "spidev") { dev.interface = IFACE::SPIDEV; dev.protocol = PROT::S25; }
+	else if (ifaceString == "wave")   { dev.interface = IFACE::WAVE;   dev.protocol = PROT::S25; }
+	else if (ifaceString == "dspi")   { dev.interface = IFACE::DSPI;   dev.protocol = PROT::S25; }
+	else if (ifaceString == "qspi")   { dev.interface = IFACE::QSPI;   dev.protocol = PROT::S25; }
+	else if (ifaceString == "i2c")    { dev.interface = IFACE::I2C;    dev.protocol = PROT::S24; }
+	else {
+		std::cerr << "Unknown interface: " << ifaceString
+		          << " (use spi, spidev, wave, dspi, qspi, i2c)" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//Highest -s value accepted for the selected interface
+int maxKHzFor(const Device &dev) {
+	return dev.interface == IFACE::SPIDEV ? Limits::SPIDEV_MAX_KHZ : Limits::MAX_KHZ;
+}
+
+//pigpio signal handler. The first signal asks the operation to stop, which
+//it does between transfers, putting the chip back as it unwinds: a chip
+//left in QPI mode or continuous read would not answer the next run.
+//A second one exits at once. Only async-signal-safe calls are made here, so
+//gpioTerminate() is left to finish() on the main thread, and pigpio's next
+//gpioInitialise() resets the DMA channels this skips
+void onSignal(int signum) {
+	(void)signum;
+	if(!splasher::stopRequested()) {
+		splasher::requestStop();
+		return;
+	}
+	static const char msg[] = "\nInterrupted again, exiting\n";
+	(void)!write(STDERR_FILENO, msg, sizeof(msg) - 1);
+	_exit(EXIT_FAILURE);
+}
+
+//End of an operation. An interrupted one exits with failure
+int finish() {
+	gpioTerminate();
+	if(splasher::stopRequested()) {
+		std::cerr << "\nStopped, the operation did not complete" << std::endl;
+		return EXIT_FAILURE;
+	}
+	return 0;
+}
+
 /******************************************************************************/
 
 /*** Main *********************************************************************/
 int main(int argc, char *argv[]){
-	/*** Generic pigpio stuff *************************************************/
-	if(gpioInitialise() < 0) {
-		std::cerr << "Error: Failed to initialise the GPIO" << std::endl;
-		exit(EXIT_FAILURE);
-	}
-
 	/*** Define CLIah Arguments ***********************************************/
 	//CLIah::Config::verbose = true; //Set verbosity when match is found
 	CLIah::Config::stringsEnabled = true; //Set arbitrary strings allowed
@@ -189,11 +410,42 @@ int main(int argc, char *argv[]){
 	CLIah::addNewArg("Write", "--write", CLIah::ArgType::flag, "-w");
 	CLIah::addNewArg("Erase", "--erase", CLIah::ArgType::flag, "-e");
 	CLIah::addNewArg("Interface", "--interface", CLIah::ArgType::subcommand, "-i");
+	CLIah::addNewArg("Gpio", "--gpio", CLIah::ArgType::subcommand, "-g");
+	CLIah::addNewArg("Spidev", "--spidev", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("Multi", "--multi", CLIah::ArgType::subcommand, "-m");
+	CLIah::addNewArg("Realtime", "--realtime", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("ReadCmd", "--read-cmd", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("Dummy", "--dummy", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("Qpi", "--qpi", CLIah::ArgType::flag);
+	CLIah::addNewArg("BlankCheck", "--blank-check", CLIah::ArgType::flag);
+	CLIah::addNewArg("Diff", "--diff", CLIah::ArgType::flag);
+	CLIah::addNewArg("Manifest", "--manifest", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("SaveManifest", "--save-manifest", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("Sample", "--sample", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("AddrMode", "--addr-mode", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("Ranges", "--ranges", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("Gap", "--gap", CLIah::ArgType::subcommand);
+	CLIah::addNewArg("Split", "--split", CLIah::ArgType::flag);
+	CLIah::addNewArg("Patch", "--patch", CLIah::ArgType::subcommand);
 
 	/*** User Argument handling ***************************************************/
 	//Get CLIah to scan the CLI Args
 	CLIah::analyseArgs(argc, argv);
 	
+	/*** Generic pigpio stuff *************************************************/
+	//The wave interface decodes MISO from pigpio's level samples, which must
+	//be taken at least twice per half clock. Has to be set before init
+	if( CLIah::isDetected("Interface") && CLIah::getSubstring("Interface") == "wave" ) {
+		gpioCfgClock(Limits::WAVE_SAMPLE_US, PI_CLOCK_PCM, 0);
+	}
+	
+	if(gpioInitialise() < 0) {
+		std::cerr << "Error: Failed to initialise the GPIO" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	gpioSetSignalFunc(SIGINT, onSignal);
+	gpioSetSignalFunc(SIGTERM, onSignal);
+	
 	if( argc == 1 ) {
 		std::cout << message::shortHelp << std::endl;
 		gpioTerminate();
@@ -211,13 +463,27 @@ int main(int argc, char *argv[]){
 		Device dev;
 		dev.interface = IFACE::SPI;
 		dev.protocol = PROT::S25;
-		dev.KHz = CLIah::isDetected("Speed") ? convertKHz(CLIah::getSubstring("Speed")) : 100;
+		if (CLIah::isDetected("Interface") &&
+		    !convertInterface(CLIah::getSubstring("Interface"), dev)) {
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		if (CLIah::isDetected("Spidev")) dev.spidevPath = CLIah::getSubstring("Spidev");
+		dev.KHz = CLIah::isDetected("Speed") ? convertKHz(CLIah::getSubstring("Speed"), maxKHzFor(dev)) : 100;
 		if (dev.KHz < 0) { gpioTerminate(); exit(EXIT_FAILURE); }
+		if (CLIah::isDetected("Gpio") &&
+		    !convertGpioDriver(CLIah::getSubstring("Gpio"), dev.gpioDriver)) {
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
 		if (splasher::readJedecId(dev)) {
 			std::cout << "JEDEC ID: " << std::hex
 			          << "0x" << (int)dev.jedecId.manufacturer << " "
 			          << "0x" << (int)dev.jedecId.memoryType << " "
 			          << "0x" << (int)dev.jedecId.capacity << std::dec << std::endl;
+			if (dev.chip) std::cout << dev.chip->name << ", " << dev.chip->bytes
+			                        << " bytes" << std::endl;
+			if (dev.caps.valid) std::cout << dev.caps.describe() << std::endl;
 			gpioTerminate();
 			exit(EXIT_SUCCESS);
 		} else {
@@ -238,13 +504,7 @@ int main(int argc, char *argv[]){
 	Device priDev;
 	priDev.offset = 0;
 	if (CLIah::isDetected("Interface")) {
-		std::string iface = CLIah::getSubstring("Interface");
-		if (iface == "spi")  { priDev.interface = IFACE::SPI;  priDev.protocol = PROT::S25; }
-		else if (iface == "dspi") { priDev.interface = IFACE::DSPI; priDev.protocol = PROT::S25; }
-		else if (iface == "qspi") { priDev.interface = IFACE::QSPI; priDev.protocol = PROT::S25; }
-		else if (iface == "i2c")  { priDev.interface = IFACE::I2C;  priDev.protocol = PROT::S24; }
-		else {
-			std::cerr << "Unknown interface: " << iface << " (use spi, dspi, qspi, i2c)" << std::endl;
+		if (!convertInterface(CLIah::getSubstring("Interface"), priDev)) {
 			gpioTerminate();
 			exit(EXIT_FAILURE);
 		}
@@ -252,18 +512,26 @@ int main(int argc, char *argv[]){
 		priDev.interface = IFACE::SPI;
 		priDev.protocol = PROT::S25;
 	}
+	if (CLIah::isDetected("Spidev")) priDev.spidevPath = CLIah::getSubstring("Spidev");
+	
+	if( CLIah::isDetected("Gpio") &&
+	    !convertGpioDriver(CLIah::getSubstring("Gpio"), priDev.gpioDriver) ) {
+		gpioTerminate();
+		exit(EXIT_FAILURE);
+	}
 	
 	if( CLIah::isDetected("Speed") ) {
-		int KHzVal = convertKHz( CLIah::getSubstring("Speed") );
+		int KHzVal = convertKHz( CLIah::getSubstring("Speed"), maxKHzFor(priDev) );
 		if(KHzVal < 0) { gpioTerminate(); exit(EXIT_FAILURE); }
 		priDev.KHz = KHzVal;
 	} else {
-		priDev.KHz = 100;
+		priDev.KHz = -1;
 	}
 	
-	bool needBytes = !CLIah::isDetected("Erase") || CLIah::isDetected("Write");
+	//Dumps and erases can take the size from the chip
+	bool needBytes = CLIah::isDetected("Write");
 	if( CLIah::isDetected("Bytes") ) {
-		unsigned long byteVal = convertBytes( CLIah::getSubstring("Bytes") );
+		uint64_t byteVal = convertBytes( CLIah::getSubstring("Bytes") );
 		if(byteVal == 0) { gpioTerminate(); exit(EXIT_FAILURE); }
 		priDev.bytes = byteVal;
 	} else if (needBytes) {
@@ -273,7 +541,7 @@ int main(int argc, char *argv[]){
 	}
 	
 	if( CLIah::isDetected("Offset") ) {
-		unsigned long offsetVal = convertBytes( CLIah::getSubstring("Offset") );
+		uint64_t offsetVal = convertBytes( CLIah::getSubstring("Offset") );
 		if(offsetVal == 0) {
 			std::cerr << message::offsetNotValid;
 			gpioTerminate();
@@ -282,23 +550,121 @@ int main(int argc, char *argv[]){
 		priDev.offset = offsetVal;
 	}
 	
+	if( CLIah::isDetected("Realtime") ) {
+		std::string cpuString = CLIah::getSubstring("Realtime");
+		if(cpuString.empty() || cpuString.length() > 3 ||
+		   cpuString.find_first_not_of("0123456789") != std::string::npos) {
+			std::cerr << message::cpuNotValid;
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		priDev.realtime = true;
+		priDev.realtimeCpu = std::stoi(cpuString);
+	}
+	
+	if( CLIah::isDetected("ReadCmd") &&
+	    !convertReadCmd(CLIah::getSubstring("ReadCmd"), priDev.readCmd) ) {
+		gpioTerminate();
+		exit(EXIT_FAILURE);
+	}
+	
+	if( CLIah::isDetected("Dummy") ) {
+		std::string dummyString = CLIah::getSubstring("Dummy");
+		if(dummyString.empty() || dummyString.length() > 2 ||
+		   dummyString.find_first_not_of("0123456789") != std::string::npos ||
+		   std::stoi(dummyString) > 32) {
+			std::cerr << message::dummyNotValid;
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		priDev.dummyCycles = std::stoi(dummyString);
+	}
+	
+	if( CLIah::isDetected("Qpi") ) {
+		if(priDev.interface != IFACE::QSPI) {
+			std::cerr << "Error: --qpi needs -i qspi" << std::endl;
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		priDev.qpi = true;
+	}
+	
+	if( CLIah::isDetected("AddrMode") &&
+	    !convertAddrMode(CLIah::getSubstring("AddrMode"), priDev.addrMode) ) {
+		gpioTerminate();
+		exit(EXIT_FAILURE);
+	}
+	
 	if (CLIah::isDetected("Erase")) {
-		unsigned long eraseCount = CLIah::isDetected("Bytes") ? priDev.bytes : 0;
+		uint64_t eraseCount = CLIah::isDetected("Bytes") ? priDev.bytes : 0;
+		priDev.blankCheck = CLIah::isDetected("BlankCheck");
 		splasher::eraseFlash(priDev, eraseCount);
-		gpioTerminate();
-		return 0;
+		return finish();
+	}
+	
+	if (CLIah::isDetected("Patch")) {
+		std::vector<Patch::Update> updates;
+		if (!Patch::parse(CLIah::getSubstring("Patch"), filename, updates)) {
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		splasher::patchFlash(priDev, updates);
+		return finish();
 	}
 	
 	if (CLIah::isDetected("Write")) {
 		BinFile binFile(filename, 'r');
+		priDev.diff = CLIah::isDetected("Diff");
+		if (CLIah::isDetected("Manifest")) priDev.manifest = CLIah::getSubstring("Manifest");
+		if (CLIah::isDetected("SaveManifest")) {
+			priDev.saveManifest = CLIah::getSubstring("SaveManifest");
+		}
+		if (priDev.diff && !priDev.manifest.empty()) {
+			std::cerr << "Error: --diff and --manifest cannot be used together" << std::endl;
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		if (CLIah::isDetected("Sample")) {
+			std::string sampleString = CLIah::getSubstring("Sample");
+			if (sampleString.empty() || sampleString.length() > 6 ||
+			    sampleString.find_first_not_of("0123456789") != std::string::npos) {
+				std::cerr << message::sampleNotValid;
+				gpioTerminate();
+				exit(EXIT_FAILURE);
+			}
+			priDev.sampleUnits = static_cast<unsigned int>(std::stoul(sampleString));
+		}
 		splasher::writeFileToFlash(priDev, binFile);
-		gpioTerminate();
-		return 0;
+		return finish();
+	}
+	
+	if (CLIah::isDetected("Ranges")) {
+		std::vector<Ranges::Range> ranges;
+		uint64_t gap = Limits::RANGE_GAP;
+		if (!Ranges::parse(CLIah::getSubstring("Ranges"), ranges)) {
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		if (CLIah::isDetected("Gap") && !Ranges::parseSize(CLIah::getSubstring("Gap"), gap)) {
+			std::cerr << message::gapNotValid;
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		splasher::dumpRanges(priDev, ranges, gap, filename, CLIah::isDetected("Split"));
+		return finish();
+	}
+	
+	if (CLIah::isDetected("Multi")) {
+		if (!convertMisoPins(CLIah::getSubstring("Multi"), priDev.misoPins)) {
+			gpioTerminate();
+			exit(EXIT_FAILURE);
+		}
+		splasher::dumpMultiToFiles(priDev, filename);
+		return finish();
 	}
 	
 	BinFile binFile(filename, 'w');
 	splasher::dumpFlashToFile(priDev, binFile);
 
-	gpioTerminate();
-	return 0;
+	return finish();
 } 
@@ -0,0 +1,102 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "manifest.hpp"
+#include "xxh64.hpp"
+
+static const char *MAGIC = "splasher-manifest";
+static const unsigned int VERSION = 1;
+
+void Manifest::hashImage(BinFile &file, uint64_t offset, uint64_t bytes, uint32_t unit) {
+	this->offset = offset;
+	this->unit = unit;
+	this->bytes = 0;
+	hashes.clear();
+	
+	std::vector<unsigned char> buf(unit);
+	const uint64_t end = offset + bytes;
+	for(uint64_t addr = unitStart(0); addr < end; addr += unit) {
+		const uint64_t from = std::max(addr, offset);
+		const size_t want = static_cast<size_t>(std::min(addr + unit, end) - from);
+		const size_t got = file.pullBytesFromFile(reinterpret_cast<char *>(buf.data()), want);
+		if(got == 0) break;
+		hashes.push_back(xxh64(buf.data(), got));
+		this->bytes += got;
+		if(got < want) break;
+	}
+}
+
+bool Manifest::save(const std::string &filename) const {
+	std::ofstream out(filename);
+	out << MAGIC << " " << VERSION << "\n"
+	    << "jedec " << jedec << "\n"
+	    << "uid " << (uid.empty() ? "-" : uid) << "\n"
+	    << "offset " << offset << "\n"
+	    << "bytes " << bytes << "\n"
+	    << "unit " << unit << "\n"
+	    << "hashes " << hashes.size() << "\n"
+	    << std::hex << std::setfill('0');
+	for(uint64_t h : hashes) out << std::setw(16) << h << "\n";
+	
+	if(!out.flush()) {
+		std::cerr << "Error: Cannot write manifest " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool Manifest::load(const std::string &filename) {
+	std::ifstream in(filename);
+	if(!in) {
+		std::cerr << "Error: Cannot open manifest " << filename << std::endl;
+		return false;
+	}
+	
+	std::string magic, jedecKey, uidKey, offsetKey, bytesKey, unitKey, hashesKey;
+	unsigned int version = 0;
+	size_t count = 0;
+	in >> magic >> version >> jedecKey >> jedec >> uidKey >> uid
+	   >> offsetKey >> offset >> bytesKey >> bytes >> unitKey >> unit
+	   >> hashesKey >> count;
+	if(!in || magic != MAGIC || version != VERSION || jedecKey != "jedec" ||
+	   uidKey != "uid" || offsetKey != "offset" || bytesKey != "bytes" ||
+	   unitKey != "unit" || hashesKey != "hashes" || unit == 0) {
+		std::cerr << "Error: " << filename << " is not a splasher manifest" << std::endl;
+		return false;
+	}
+	if(uid == "-") uid.clear();
+	
+	//One hash per unit the range touches, a partial unit at each end included
+	const uint64_t head = offset % unit;
+	if(bytes > UINT64_MAX - head - unit) {
+		std::cerr << "Error: Manifest " << filename << " has an invalid range" << std::endl;
+		return false;
+	}
+	const uint64_t units = (head + bytes + unit - 1) / unit;
+	if(count != units) {
+		std::cerr << "Error: Manifest " << filename << " lists " << count
+		          << " hashes, its range covers " << units << " units" << std::endl;
+		return false;
+	}
+	hashes.resize(count);
+	in >> std::hex;
+	for(uint64_t &h : hashes) in >> h;
+	if(!in) {
+		std::cerr << "Error: Manifest " << filename << " is missing hashes" << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <iostream>
+
+#include "patch.hpp"
+#include "ranges.hpp"
+#include "filemanager.hpp"
+
+namespace Patch {
+
+//Hex bytes, ':' separators allowed anywhere between them
+static bool parseHex(const std::string &text, std::vector<unsigned char> &data) {
+	std::string digits;
+	for(char c : text) {
+		if(c != ':') digits.push_back(c);
+	}
+	if(digits.empty() || digits.size() % 2 != 0 ||
+	   digits.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) {
+		return false;
+	}
+	
+	data.clear();
+	for(size_t i = 0; i < digits.size(); i += 2) {
+		data.push_back(static_cast<unsigned char>(std::stoul(digits.substr(i, 2), nullptr, 16)));
+	}
+	return true;
+}
+
+//The whole of filename
+static std::vector<unsigned char> readFile(const std::string &filename) {
+	std::vector<unsigned char> data;
+	BinFile file(filename.c_str(), 'r', 65536);
+	char buf[4096];
+	size_t got;
+	while((got = file.pullBytesFromFile(buf, sizeof(buf))) > 0) {
+		data.insert(data.end(), buf, buf + got);
+	}
+	return data;
+}
+
+bool parse(const std::string &list, const std::string &filename,
+           std::vector<Update> &updates) {
+	updates.clear();
+	std::vector<unsigned char> fileData;
+	bool fileRead = false;
+	
+	size_t pos = 0;
+	while(pos <= list.size()) {
+		size_t comma = list.find(',', pos);
+		if(comma == std::string::npos) comma = list.size();
+		const std::string item = list.substr(pos, comma - pos);
+		pos = comma + 1;
+		
+		const size_t eq = item.find('=');
+		Update update{0, {}};
+		if(!Ranges::parseSize(item.substr(0, eq), update.addr) ||
+		   (eq != std::string::npos && !parseHex(item.substr(eq + 1), update.data))) {
+			std::cerr << "Error: Patch \"" << item << "\" is invalid. e.g. "
+			          << "--patch 0x3FF000=00:16:3e:5a:1b:2c,0x3F800" << std::endl;
+			return false;
+		}
+		
+		//A bare address takes the file, read once however often it is used
+		if(eq == std::string::npos) {
+			if(!fileRead) {
+				fileData = readFile(filename);
+				fileRead = true;
+			}
+			update.data = fileData;
+		}
+		if(update.data.empty()) {
+			std::cerr << "Error: Patch \"" << item << "\" is empty" << std::endl;
+			return false;
+		}
+		updates.push_back(update);
+	}
+	return true;
+}
+
+} //namespace Patch
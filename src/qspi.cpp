@@ -0,0 +1,86 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "hardware.hpp"
+
+#include <cstring>
+
+/*** Quad SPI Interface *******************************************************/
+hwQSPI::hwQSPI(int SCLK, int MOSI, int MISO, int CS, int WP, int HOLD,
+               GpioMem *mem)
+	: hwDSPI(SCLK, MOSI, MISO, CS, WP, mem) {
+	io_HOLD = HOLD;
+	
+	//Four bits per clock, IO0-IO3 = MOSI, MISO, WP, HOLD
+	quadLanes = {mask_SCLK,
+	             {mask_MOSI, mask_MISO, 1u << WP, 1u << HOLD},
+	             {static_cast<uint8_t>(MOSI), static_cast<uint8_t>(MISO),
+	              static_cast<uint8_t>(WP), static_cast<uint8_t>(HOLD)}};
+	
+	//HOLD has not been driven before, release the chip from hold
+	setQuadDir(IoDir::SINGLE);
+}
+
+void hwQSPI::setQuadDir(IoDir dir) {
+	if(dir == quadDir) return;
+	
+	pinMode(io_WP, dir != IoDir::IN);
+	pinMode(io_HOLD, dir != IoDir::IN);
+	
+	//Quad writes leave data on the lines, put WP and HOLD back
+	if(dir == IoDir::SINGLE) {
+		pinWrite(io_WP, wpLevel ? 1 : 0);
+		pinWrite(io_HOLD, 1);
+	}
+	quadDir = dir;
+}
+
+void hwQSPI::stop() {
+	hwDSPI::stop();
+	setQuadDir(IoDir::SINGLE);
+}
+
+const Kernel::Lanes &hwQSPI::prepareLanes(unsigned int lanes, bool output) {
+	if(lanes != 4) {
+		setQuadDir(IoDir::SINGLE);
+		return hwDSPI::prepareLanes(lanes, output);
+	}
+	
+	IoDir dir = output ? IoDir::OUT : IoDir::IN;
+	setIoDir(dir);
+	setQuadDir(dir);
+	return quadLanes;
+}
+
+void hwQSPI::transfer(const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(!qpiMode) {
+		hwDSPI::transfer(tx, rx, n);
+		return;
+	}
+	
+	if(tx != nullptr) {
+		writeWide(tx, n, 4);
+		if(rx != nullptr) memset(rx, 0, n);
+	} else if(rx != nullptr) {
+		readWide(rx, n, 4);
+	} else {
+		dummy(static_cast<unsigned int>(n * 2));
+	}
+}
+
+bool hwQSPI::dummy(unsigned int cycles) {
+	if(!qpiMode) return hwDSPI::dummy(cycles);
+	
+	//Lines released, the chip may start driving them before the data
+	bitbangLanes(prepareLanes(4, false), 4, nullptr, nullptr, cycles / 2);
+	clockBits(cycles % 2);
+	return true;
+}
@@ -0,0 +1,92 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <algorithm>
+#include <iostream>
+
+#include "ranges.hpp"
+
+/*** Parsing ******************************************************************/
+namespace Ranges {
+
+bool parseSize(std::string text, uint64_t &value) {
+	uint64_t multiplier = 1;
+	if(!text.empty() && (text.back() == 'K' || text.back() == 'M')) {
+		multiplier = (text.back() == 'K') ? 1024 : 1048576;
+		text.pop_back();
+	}
+
+	int base = 10;
+	const char *digits = "0123456789";
+	if(text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+		base = 16;
+		digits = "0123456789abcdefABCDEF";
+		text.erase(0, 2);
+	}
+
+	if(text.empty() || text.length() > 10 ||
+	   text.find_first_not_of(digits) != std::string::npos) return false;
+
+	value = std::stoull(text, nullptr, base) * multiplier;
+	return value <= 0x100000000ull;
+}
+
+bool parse(const std::string &list, std::vector<Range> &ranges) {
+	ranges.clear();
+	size_t pos = 0;
+	while(pos <= list.size()) {
+		size_t comma = list.find(',', pos);
+		if(comma == std::string::npos) comma = list.size();
+		const std::string item = list.substr(pos, comma - pos);
+		pos = comma + 1;
+
+		//'+' is a length, '-' an end address
+		size_t split = item.find_first_of("+-");
+		uint64_t start = 0, second = 0;
+		if(split == std::string::npos ||
+		   !parseSize(item.substr(0, split), start) ||
+		   !parseSize(item.substr(split + 1), second)) {
+			std::cerr << "Error: Range \"" << item << "\" is invalid. e.g. "
+			          << "--ranges 0+64K,0x3F0000-4M" << std::endl;
+			return false;
+		}
+
+		const uint64_t bytes = (item[split] == '+') ? second
+		                     : (second > start ? second - start : 0);
+		if(bytes == 0) {
+			std::cerr << "Error: Range \"" << item << "\" is empty" << std::endl;
+			return false;
+		}
+		ranges.push_back(Range{start, bytes});
+	}
+	return true;
+}
+
+std::vector<Read> coalesce(std::vector<Range> &ranges, uint64_t gap) {
+	std::sort(ranges.begin(), ranges.end(), [](const Range &a, const Range &b) {
+		return a.start < b.start || (a.start == b.start && a.bytes < b.bytes);
+	});
+
+	std::vector<Read> reads;
+	for(size_t i = 0; i < ranges.size(); i++) {
+		const Range &r = ranges[i];
+		if(!reads.empty() && r.start <= reads.back().end() + gap) {
+			Read &read = reads.back();
+			read.bytes = std::max(read.end(), r.end()) - read.start;
+			read.parts.push_back(i);
+		} else {
+			reads.push_back(Read{r.start, r.bytes, {i}});
+		}
+	}
+	return reads;
+}
+
+} //namespace Ranges
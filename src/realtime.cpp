@@ -0,0 +1,112 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "realtime.hpp"
+#include "timing.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace Realtime {
+
+bool enter(int cpu) {
+	bool ok = true;
+
+	if(cpu >= 0) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		if(err != 0) {
+			std::cerr << "Warning: Cannot pin transfer thread to CPU " << cpu
+			          << ": " << strerror(err) << std::endl;
+			ok = false;
+		}
+	}
+
+	sched_param param = {};
+	param.sched_priority = FIFO_PRIORITY;
+	int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if(err != 0) {
+		std::cerr << "Warning: Cannot switch transfer thread to SCHED_FIFO: "
+		          << strerror(err) << std::endl;
+		ok = false;
+	}
+
+	if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+		std::cerr << "Warning: Cannot lock memory: " << strerror(errno)
+		          << std::endl;
+		ok = false;
+	}
+
+	return ok;
+}
+
+void leave() {
+	sched_param param = {};
+	param.sched_priority = 0;
+	pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+	munlockall();
+}
+
+/*** Progress *****************************************************************/
+Progress::Progress(const std::string &label, const std::string &suffix)
+	: label(label), suffix(suffix), done(0), running(true) {
+	worker = std::thread([this] {
+		while(running.load()) {
+			print();
+			std::this_thread::sleep_for(std::chrono::milliseconds(PROGRESS_MS));
+		}
+	});
+}
+
+Progress::~Progress() {
+	stop();
+}
+
+void Progress::stop() {
+	if(!worker.joinable()) return;
+	running.store(false);
+	worker.join();
+	print();
+}
+
+void Progress::print() {
+	std::cout << "\r" << label << " " << done.load() / 1024 << "KiB" << suffix
+	          << std::flush;
+}
+
+/*** Overrun counter **********************************************************/
+void OverrunCounter::begin() {
+	started = Timing::nowNs();
+}
+
+void OverrunCounter::end(unsigned long bytes) {
+	if(KHz == 0) return;
+	uint64_t took = Timing::nowNs() - started;
+
+	//1e6 / KHz ns per clock
+	uint64_t budget = static_cast<uint64_t>(
+		(bytes * double(clocksPerByte) * 1000000.0 / KHz) * OVERRUN_MARGIN);
+
+	++total;
+	if(took > budget) {
+		++count;
+		if(took - budget > worstNs) worstNs = took - budget;
+	}
+}
+
+} //namespace Realtime
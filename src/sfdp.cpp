@@ -0,0 +1,181 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "sfdp.hpp"
+
+/*** Helpers ******************************************************************/
+//SFDP is little endian. DWORDs are numbered from 1, as in JESD216
+static uint32_t dword(const unsigned char *buf, unsigned int n) {
+	const unsigned char *p = buf + (n - 1) * 4;
+	return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+	       (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint32_t field(uint32_t value, unsigned int hi, unsigned int lo) {
+	return (value >> lo) & ((1u << (hi - lo + 1)) - 1);
+}
+
+//Fast read parameters are packed two to a DWORD, 16 bits each:
+//  dummy clocks 4:0, mode clocks 7:5, opcode 15:8
+static void parseRead(uint32_t half, bool supported, unsigned int addrLanes,
+                      unsigned int dataLanes, FlashCaps::Read &read) {
+	read.supported = supported;
+	read.addrLanes = addrLanes;
+	read.dataLanes = dataLanes;
+	if(!supported) return;
+	read.dummyClocks = field(half, 4, 0);
+	read.modeClocks = field(half, 7, 5);
+	read.cmd = static_cast<unsigned char>(field(half, 15, 8));
+}
+
+//Erase types are 16 bits each: size as a power of two 7:0, opcode 15:8
+static void parseErase(uint32_t half, FlashCaps::Erase &erase) {
+	unsigned int power = field(half, 7, 0);
+	if(power == 0 || power > 31) return;
+	erase.bytes = 1u << power;
+	erase.cmd = static_cast<unsigned char>(field(half, 15, 8));
+}
+
+static std::string sizeString(uint64_t bytes) {
+	if(bytes >= 1048576 && bytes % 1048576 == 0) return std::to_string(bytes / 1048576) + "MiB";
+	if(bytes >= 1024 && bytes % 1024 == 0) return std::to_string(bytes / 1024) + "KiB";
+	return std::to_string(bytes) + "B";
+}
+
+/*** FlashCaps ****************************************************************/
+const FlashCaps::Erase *FlashCaps::smallestErase() const {
+	const Erase *best = nullptr;
+	for(const Erase &e : erase) {
+		if(e.bytes != 0 && (best == nullptr || e.bytes < best->bytes)) best = &e;
+	}
+	return best;
+}
+
+const FlashCaps::Read *FlashCaps::findRead(unsigned char cmd) const {
+	for(const Read *r : {&read112, &read122, &read114, &read144}) {
+		if(r->supported && r->cmd == cmd) return r;
+	}
+	return nullptr;
+}
+
+std::string FlashCaps::describe() const {
+	std::string out = "SFDP " + std::to_string(revMajor) + "." + std::to_string(revMinor);
+	if(bytes != 0) out += ", " + sizeString(bytes);
+	out += ", page " + std::to_string(pageSize) + ", erase";
+	for(const Erase &e : erase) {
+		if(e.bytes != 0) out += " " + sizeString(e.bytes);
+	}
+
+	out += ", reads 1-1-1";
+	const char *names[4] = {"1-1-2", "1-2-2", "1-1-4", "1-4-4"};
+	const Read *reads[4] = {&read112, &read122, &read114, &read144};
+	for(unsigned int i = 0; i < 4; i++) {
+		if(reads[i]->supported) out += std::string(" ") + names[i];
+	}
+
+	if(addr4) out += opcodes4 ? ", 4-byte opcodes" : ", 4-byte mode";
+	return out;
+}
+
+/*** Parsing ******************************************************************/
+namespace Sfdp {
+
+unsigned int parseHeader(const unsigned char *buf, FlashCaps &caps) {
+	//"SFDP" read as a little endian DWORD
+	if(dword(buf, 1) != 0x50444653u) return 0;
+
+	caps.revMinor = buf[4];
+	caps.revMajor = buf[5];
+	if(caps.revMajor != 1) return 0;
+	return static_cast<unsigned int>(buf[6]) + 1;
+}
+
+Table parseTable(const unsigned char *buf) {
+	Table table;
+	table.id = static_cast<uint16_t>(buf[0] | (buf[7] << 8));
+	table.revMinor = buf[1];
+	table.revMajor = buf[2];
+	table.dwords = buf[3];
+	table.pointer = static_cast<uint32_t>(buf[4]) | (static_cast<uint32_t>(buf[5]) << 8) |
+	                (static_cast<uint32_t>(buf[6]) << 16);
+	return table;
+}
+
+bool parseBfpt(const unsigned char *buf, unsigned int dwords, FlashCaps &caps) {
+	//The first JESD216 table had 9 DWORDs, revision A onwards has 16 or more
+	if(dwords < 9) return false;
+
+	//DWORD 1: address bytes 18:17, supported fast reads
+	uint32_t dw1 = dword(buf, 1);
+	switch(field(dw1, 18, 17)) {
+		case 0: caps.addr3 = true;  caps.addr4 = false; break;
+		case 1: caps.addr3 = true;  caps.addr4 = true;  break;
+		case 2: caps.addr3 = false; caps.addr4 = true;  break;
+		default: break;
+	}
+
+	//DWORD 2: density in bits, N - 1, or 2^N when bit 31 is set
+	uint32_t dw2 = dword(buf, 2);
+	if(dw2 & 0x80000000u) {
+		uint32_t power = dw2 & 0x7FFFFFFFu;
+		caps.bytes = (power >= 3 && power < 67) ? (uint64_t(1) << (power - 3)) : 0;
+	} else {
+		caps.bytes = (static_cast<uint64_t>(dw2) + 1) / 8;
+	}
+
+	//DWORDs 3 and 4: 1-4-4 / 1-1-4 and 1-1-2 / 1-2-2 parameters
+	uint32_t dw3 = dword(buf, 3);
+	uint32_t dw4 = dword(buf, 4);
+	parseRead(dw3 & 0xFFFF, dw1 & (1u << 21), 4, 4, caps.read144);
+	parseRead(dw3 >> 16,    dw1 & (1u << 22), 1, 4, caps.read114);
+	parseRead(dw4 & 0xFFFF, dw1 & (1u << 16), 1, 2, caps.read112);
+	parseRead(dw4 >> 16,    dw1 & (1u << 20), 2, 2, caps.read122);
+
+	//DWORDs 8 and 9: erase types 1-4
+	for(unsigned int i = 0; i < 4; i++) {
+		uint32_t dw = dword(buf, 8 + i / 2);
+		caps.erase[i] = FlashCaps::Erase();
+		parseErase((i % 2) ? (dw >> 16) : (dw & 0xFFFF), caps.erase[i]);
+	}
+
+	//DWORD 11: page size as a power of two, 7:4
+	if(dwords >= 11) {
+		unsigned int power = field(dword(buf, 11), 7, 4);
+		if(power != 0) caps.pageSize = 1u << power;
+	}
+
+	//DWORD 15: Quad Enable requirements, 22:20
+	if(dwords >= 15) {
+		switch(field(dword(buf, 15), 22, 20)) {
+			case 0:  caps.qe = FlashCaps::QE::NONE;             break;
+			case 1:  caps.qe = FlashCaps::QE::SR2_BIT1_NO_READ; break;
+			case 2:  caps.qe = FlashCaps::QE::SR1_BIT6;         break;
+			case 3:  caps.qe = FlashCaps::QE::SR2_BIT7;         break;
+			case 4: case 5:
+			         caps.qe = FlashCaps::QE::SR2_BIT1;         break;
+			case 6:  caps.qe = FlashCaps::QE::SR2_BIT1_WRSR2;   break;
+			default: caps.qe = FlashCaps::QE::UNKNOWN;          break;
+		}
+	}
+
+	//DWORD 16: ways to enter 4-byte addressing, 31:24
+	if(dwords >= 16) {
+		uint32_t enter = field(dword(buf, 16), 31, 24);
+		caps.enter4Cmd = (enter & 0x03) != 0;
+		caps.enter4Ear = (enter & 0x04) != 0;
+		caps.opcodes4 = (enter & 0x20) != 0;
+	}
+
+	caps.valid = true;
+	return true;
+}
+
+} //namespace Sfdp
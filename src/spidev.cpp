@@ -0,0 +1,152 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "hardware.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+//Default ioctl, used unless a stand-in is passed to the constructor
+static int spidevIoctl(int fd, unsigned long request, void *arg) {
+	return ioctl(fd, request, arg);
+}
+
+/*** Linux spidev Hardware SPI Interface **************************************/
+hwSpidev::hwSpidev(const std::string &path, unsigned int speedHz,
+                   SpidevIoctl ioctlFn) {
+	speed = speedHz;
+	this->ioctlFn = (ioctlFn != nullptr) ? ioctlFn : spidevIoctl;
+
+	//The driver rejects messages larger than its bufsiz module parameter
+	std::ifstream bufsizFile("/sys/module/spidev/parameters/bufsiz");
+	size_t sysBufsiz = 0;
+	if(bufsizFile >> sysBufsiz && sysBufsiz != 0) bufsiz = sysBufsiz;
+
+	fd = ::open(path.c_str(), O_RDWR);
+	if(fd < 0) {
+		std::cerr << "Error: Cannot open " << path << ": " << strerror(errno)
+		          << std::endl;
+		return;
+	}
+
+	//Mode 0, MSB first, 8 bit words
+	uint8_t mode = SPI_MODE_0;
+	uint8_t bits = 8;
+
+	if(this->ioctlFn(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+	   this->ioctlFn(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+	   this->ioctlFn(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+		std::cerr << "Error: Cannot configure " << path << ": "
+		          << strerror(errno) << std::endl;
+		::close(fd);
+		fd = -1;
+		return;
+	}
+}
+
+hwSpidev::~hwSpidev() {
+	if(fd >= 0) ::close(fd);
+}
+
+bool hwSpidev::setSpeed(unsigned int speedHz) {
+	if(fd < 0) return false;
+	if(this->ioctlFn(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speedHz) < 0) {
+		std::cerr << "Error: spidev refused " << speedHz << "Hz: "
+		          << strerror(errno) << std::endl;
+		return false;
+	}
+	speed = speedHz;
+	return true;
+}
+
+bool hwSpidev::message(const unsigned char *tx, unsigned char *rx, size_t n,
+                       bool keepCs) {
+	struct spi_ioc_transfer xfer;
+	memset(&xfer, 0, sizeof(xfer));
+
+	xfer.tx_buf = reinterpret_cast<uintptr_t>(tx);
+	xfer.rx_buf = reinterpret_cast<uintptr_t>(rx);
+	xfer.len = static_cast<uint32_t>(n);
+	xfer.speed_hz = speed;
+	xfer.bits_per_word = 8;
+	//On the last transfer of a message, cs_change leaves CE asserted
+	xfer.cs_change = keepCs ? 1 : 0;
+
+	if(ioctlFn(fd, SPI_IOC_MESSAGE(1), &xfer) < 0) {
+		std::cerr << "Error: spidev transfer failed: " << strerror(errno)
+		          << std::endl;
+		setFailed();
+		return false;
+	}
+	return true;
+}
+
+void hwSpidev::start() {
+	//CE is asserted by the first message after start()
+}
+
+void hwSpidev::stop() {
+	//An empty message without cs_change releases CE
+	if(fd >= 0) message(nullptr, nullptr, 0, false);
+}
+
+void hwSpidev::transfer(const unsigned char *tx, unsigned char *rx, size_t n) {
+	if(fd < 0) {
+		setFailed();
+		return;
+	}
+
+	//Split into bufsiz messages, CE stays asserted between them so one
+	//command can stream any amount of data
+	while(n > 0) {
+		size_t chunk = (n > bufsiz) ? bufsiz : n;
+		if(!message(tx, rx, chunk, true)) return;
+
+		if(tx != nullptr) tx += chunk;
+		if(rx != nullptr) rx += chunk;
+		n -= chunk;
+	}
+}
+
+char hwSpidev::readByte() {
+	unsigned char byte = 0;
+	transfer(nullptr, &byte, 1);
+	return static_cast<char>(byte);
+}
+
+void hwSpidev::writeByte(char byte) {
+	const unsigned char out = static_cast<unsigned char>(byte);
+	transfer(&out, nullptr, 1);
+}
+
+bool hwSpidev::readId(ChipId &id) {
+	if(fd < 0) return false;
+
+	const unsigned char cmd = Cmd::S25::READ_JEDEC_ID;
+	unsigned char idBytes[3];
+
+	start();
+	write(&cmd, 1);
+	read(idBytes, 3);
+	stop();
+
+	id.manufacturer = idBytes[0];
+	id.memoryType   = idBytes[1];
+	id.capacity     = idBytes[2];
+	return true;
+}
@@ -0,0 +1,69 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "timing.hpp"
+
+#include <time.h>
+
+namespace Timing {
+
+//Loops per microsecond, 0 until calibrate() has run
+static double spinRate = 0.0;
+
+uint64_t nowNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000u +
+	       static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void calibrate() {
+	if(spinRate != 0.0) return;
+
+	//Time a fixed number of loops a few times, keep the fastest run. Slower
+	//runs were interrupted, or caught the CPU before it clocked up
+	const uint32_t loops = 200000;
+	uint64_t best = 0;
+	for(int run = 0; run < 5; run++) {
+		uint64_t start = nowNs();
+		spin(loops);
+		uint64_t took = nowNs() - start;
+		if(best == 0 || took < best) best = took;
+	}
+
+	if(best == 0) best = 1;
+	spinRate = (static_cast<double>(loops) * 1000.0) / static_cast<double>(best);
+}
+
+double loopsPerUs() {
+	calibrate();
+	return spinRate;
+}
+
+Wait makeWait(uint32_t ns) {
+	Wait wait;
+	if(ns == 0) return wait;
+
+	if(ns < MIN_NS) ns = MIN_NS;
+	if(ns > MAX_NS) ns = MAX_NS;
+
+	wait.ns = ns;
+	wait.loops = static_cast<uint32_t>((loopsPerUs() * ns) / 1000.0);
+	if(wait.loops == 0) wait.loops = 1;
+	return wait;
+}
+
+void pollNs(uint32_t ns) {
+	uint64_t end = nowNs() + ns;
+	while(nowNs() < end) {}
+}
+
+} //namespace Timing
@@ -0,0 +1,73 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "wave.hpp"
+#include "kernels.hpp"
+
+namespace Wave {
+
+void buildPulses(const unsigned char *tx, size_t n, uint32_t mosiMask,
+                 uint32_t sclkMask, unsigned int halfUs,
+                 std::vector<Pulse> &pulses) {
+	pulses.reserve(pulses.size() + (n * 16) + 1);
+
+	//The same single lane kernel as hwSPI, recording pulses instead of
+	//driving pins. Each half period becomes one pulse
+	Kernel::WavePort port(pulses);
+	Kernel::DmaDelay delay = {halfUs};
+	Kernel::Lanes lanes = {sclkMask, {mosiMask, 0, 0, 0}, {0, 0, 0, 0}};
+
+	Kernel::BitKernel<Kernel::WavePort, Kernel::DmaDelay, 1>::run(
+		port, delay, lanes, tx, nullptr, n);
+
+	//Return SCLK low so the final bit's high phase ends
+	if(n != 0) port.emit(halfUs);
+}
+
+void MisoDecoder::reset(uint32_t sclkMask, uint32_t misoMask, size_t bits,
+                        unsigned char *rx) {
+	sclk = sclkMask;
+	miso = misoMask;
+	bitsWanted = bits;
+	bitsDone = 0;
+	out = rx;
+
+	//The interface idles with SCLK low
+	sclkHigh = false;
+	misoLevel = false;
+	acc = 0;
+}
+
+bool MisoDecoder::feed(const Sample *samples, size_t count) {
+	for(size_t i = 0; i < count && bitsDone < bitsWanted; i++) {
+		bool high = (samples[i].level & sclk) != 0;
+
+		//Track MISO through the high phase, keep the last level seen
+		if(high) misoLevel = (samples[i].level & miso) != 0;
+
+		//A falling edge completes the bit
+		if(sclkHigh && !high) {
+			acc = static_cast<unsigned char>((acc << 1) | (misoLevel ? 1 : 0));
+			++bitsDone;
+
+			if((bitsDone % 8) == 0) {
+				if(out != nullptr) out[(bitsDone / 8) - 1] = acc;
+				acc = 0;
+			}
+		}
+
+		sclkHigh = high;
+	}
+
+	return done();
+}
+
+} //namespace Wave
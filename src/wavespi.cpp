@@ -0,0 +1,159 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "hardware.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <pigpio.h>
+
+//Wave structs are handed to pigpio as-is
+static_assert(sizeof(Wave::Pulse) == sizeof(gpioPulse_t), "Pulse layout");
+static_assert(sizeof(Wave::Sample) == sizeof(gpioSample_t), "Sample layout");
+
+//Waves chained per gpioWaveChain() call, and the most bytes in one wave
+static const size_t WAVES_PER_BATCH = 2;
+static const size_t MAX_WAVE_BYTES = 512;
+
+//pigpio sample callback, forwards to the owning interface
+static void waveSamples(const gpioSample_t *samples, int count, void *user) {
+	static_cast<hwWaveSPI *>(user)->feedSamples(
+		reinterpret_cast<const Wave::Sample *>(samples),
+		static_cast<size_t>(count));
+}
+
+/*** DMA Timed Waveform SPI Interface *****************************************/
+hwWaveSPI::hwWaveSPI(int SCLK, int MOSI, int MISO, int CS, int WP)
+	: hwSPI(SCLK, MOSI, MISO, CS, WP) {
+	//The decoder only looks at SCLK and MISO
+	gpioSetGetSamplesFuncEx(waveSamples, mask_SCLK | mask_MISO, this);
+}
+
+hwWaveSPI::~hwWaveSPI() {
+	gpioWaveTxStop();
+	gpioSetGetSamplesFuncEx(nullptr, 0, nullptr);
+}
+
+void hwWaveSPI::setTiming(unsigned int KHz) {
+	halfUs = (KHz == 0) ? Limits::WAVE_MIN_HALF_US : 500 / KHz;
+	if(halfUs < Limits::WAVE_MIN_HALF_US) halfUs = Limits::WAVE_MIN_HALF_US;
+
+	//CS setup/hold delays stay CPU timed, the clock itself is exact
+	wait_cs = Timing::makeWait(halfUs * 1000);
+	achieved = 500 / halfUs;
+}
+
+void hwWaveSPI::feedSamples(const Wave::Sample *samples, size_t count) {
+	std::lock_guard<std::mutex> lock(sampleMutex);
+	if(!decoding) return;
+
+	//Skip samples taken before the batch was armed
+	size_t first = 0;
+	while(first < count &&
+	      static_cast<int32_t>(samples[first].tick - armTick) < 0) ++first;
+
+	if(decoder.feed(samples + first, count - first)) {
+		decoding = false;
+		sampleDone.notify_one();
+	}
+}
+
+bool hwWaveSPI::sendBatch(const unsigned char *tx, unsigned char *rx,
+                          size_t n) {
+	//Bytes per wave within pigpio's pulse limit, 16 pulses per byte
+	size_t waveBytes = (static_cast<size_t>(gpioWaveGetMaxPulses()) - 1) / 16;
+	if(waveBytes > MAX_WAVE_BYTES) waveBytes = MAX_WAVE_BYTES;
+
+	char chain[WAVES_PER_BATCH];
+	unsigned int waves = 0;
+	std::vector<Wave::Pulse> pulses;
+	bool ok = true;
+
+	for(size_t done = 0; done < n && waves < WAVES_PER_BATCH; done += waveBytes) {
+		size_t chunk = (n - done < waveBytes) ? n - done : waveBytes;
+
+		pulses.clear();
+		Wave::buildPulses(tx ? tx + done : nullptr, chunk, mask_MOSI,
+		                  mask_SCLK, halfUs, pulses);
+
+		gpioWaveAddNew();
+		gpioWaveAddGeneric(static_cast<unsigned int>(pulses.size()),
+		                   reinterpret_cast<gpioPulse_t *>(pulses.data()));
+		int id = gpioWaveCreate();
+		if(id < 0) {
+			std::cerr << "Error: Cannot create DMA waveform (" << id << ")"
+			          << std::endl;
+			ok = false;
+			break;
+		}
+		chain[waves++] = static_cast<char>(id);
+	}
+
+	if(ok) {
+		//Arm the decoder, then run the waves back to back
+		{
+			std::lock_guard<std::mutex> lock(sampleMutex);
+			decoder.reset(mask_SCLK, mask_MISO, n * 8, rx);
+			armTick = gpioTick();
+			decoding = true;
+		}
+		gpioWaveChain(chain, waves);
+		while(gpioWaveTxBusy()) gpioDelay(100);
+
+		//Samples arrive from pigpio about once per millisecond
+		std::unique_lock<std::mutex> lock(sampleMutex);
+		if(!sampleDone.wait_for(lock, std::chrono::seconds(1),
+		                        [this]{ return !decoding; })) {
+			std::cerr << "Error: MISO samples missing, only "
+			          << decoder.decodedBits() << " of " << n * 8
+			          << " bits decoded" << std::endl;
+			decoding = false;
+			ok = false;
+		}
+	}
+
+	for(unsigned int i = 0; i < waves; i++) {
+		gpioWaveDelete(static_cast<unsigned char>(chain[i]));
+	}
+	return ok;
+}
+
+void hwWaveSPI::transfer(const unsigned char *tx, unsigned char *rx,
+                         size_t n) {
+	size_t waveBytes = (static_cast<size_t>(gpioWaveGetMaxPulses()) - 1) / 16;
+	if(waveBytes > MAX_WAVE_BYTES) waveBytes = MAX_WAVE_BYTES;
+	const size_t batchBytes = waveBytes * WAVES_PER_BATCH;
+
+	while(n > 0) {
+		size_t chunk = (n > batchBytes) ? batchBytes : n;
+
+		if(!sendBatch(tx, rx, chunk)) {
+			setFailed();
+			return;
+		}
+
+		if(tx != nullptr) tx += chunk;
+		if(rx != nullptr) rx += chunk;
+		n -= chunk;
+	}
+}
+
+char hwWaveSPI::readByte() {
+	unsigned char byte = 0;
+	transfer(nullptr, &byte, 1);
+	return static_cast<char>(byte);
+}
+
+void hwWaveSPI::writeByte(char byte) {
+	const unsigned char out = static_cast<unsigned char>(byte);
+	transfer(&out, nullptr, 1);
+}
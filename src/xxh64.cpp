@@ -0,0 +1,99 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstring>
+
+#include "xxh64.hpp"
+
+static const uint64_t P1 = 0x9E3779B185EBCA87ull;
+static const uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t P3 = 0x165667B19E3779F9ull;
+static const uint64_t P4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t P5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotl(uint64_t x, unsigned int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+//Little endian loads, as the reference defines them
+static inline uint64_t load64(const unsigned char *p) {
+	uint64_t v;
+	memcpy(&v, p, 8);
+	#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+	#endif
+	return v;
+}
+
+static inline uint32_t load32(const unsigned char *p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap32(v);
+	#endif
+	return v;
+}
+
+static inline uint64_t lane(uint64_t acc, uint64_t input) {
+	acc += input * P2;
+	return rotl(acc, 31) * P1;
+}
+
+static inline uint64_t mergeRound(uint64_t acc, uint64_t v) {
+	acc ^= lane(0, v);
+	return acc * P1 + P4;
+}
+
+uint64_t xxh64(const unsigned char *data, size_t n, uint64_t seed) {
+	const unsigned char *p = data;
+	const unsigned char *const end = data + n;
+	uint64_t h;
+	
+	//Four independent lanes over 32 byte stripes
+	if(n >= 32) {
+		uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+		for(; p + 32 <= end; p += 32) {
+			v1 = lane(v1, load64(p));
+			v2 = lane(v2, load64(p + 8));
+			v3 = lane(v3, load64(p + 16));
+			v4 = lane(v4, load64(p + 24));
+		}
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = mergeRound(h, v1);
+		h = mergeRound(h, v2);
+		h = mergeRound(h, v3);
+		h = mergeRound(h, v4);
+	} else {
+		h = seed + P5;
+	}
+	h += n;
+	
+	for(; p + 8 <= end; p += 8) {
+		h ^= lane(0, load64(p));
+		h = rotl(h, 27) * P1 + P4;
+	}
+	if(p + 4 <= end) {
+		h ^= uint64_t(load32(p)) * P1;
+		h = rotl(h, 23) * P2 + P3;
+		p += 4;
+	}
+	for(; p < end; p++) {
+		h ^= *p * P5;
+		h = rotl(h, 11) * P1;
+	}
+	
+	h ^= h >> 33;
+	h *= P2;
+	h ^= h >> 29;
+	h *= P3;
+	h ^= h >> 32;
+	return h;
+}
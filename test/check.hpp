@@ -0,0 +1,43 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstdio>
+
+#ifndef CHECK_H
+#define CHECK_H
+
+/*** Minimal test harness *****************************************************/
+//Each test is a program built by `make test` from the modules that need no
+//pigpio or Pi. CHECK() prints the failing expression and carries on, so one
+//run reports every failure; main() returns Check::result()
+namespace Check {
+	inline unsigned int failures = 0;
+
+	inline void that(bool ok, const char *expr, const char *file, int line) {
+		if(ok) return;
+		++failures;
+		std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expr);
+	}
+
+	//Prints the summary, 0 when everything passed
+	inline int result(const char *name) {
+		if(failures == 0) {
+			std::printf("%s: passed\n", name);
+			return 0;
+		}
+		std::printf("%s: %u failed\n", name, failures);
+		return 1;
+	}
+} //namespace Check
+
+#define CHECK(expr) Check::that((expr), #expr, __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "check.hpp"
+#include "eraseplan.hpp"
+
+//Steps are in address order, each aligned to its own size, and cover the
+//plan's range with no gaps or overlaps
+static bool tiles(const ErasePlan::Plan &plan) {
+	uint64_t addr = plan.start;
+	for(const ErasePlan::Step &step : plan.steps) {
+		if(step.addr != addr || step.addr % step.bytes != 0) return false;
+		addr += step.bytes;
+	}
+	return addr == plan.end;
+}
+
+static size_t count(const ErasePlan::Plan &plan, uint32_t bytes) {
+	size_t n = 0;
+	for(const ErasePlan::Step &step : plan.steps) n += (step.bytes == bytes);
+	return n;
+}
+
+int main() {
+	const ChipDb::Timing timing = {400, 3000, 45, 400, 150, 2000, 2500, 12500};
+	const std::vector<ErasePlan::Type> types = {
+		{4096, 0x20, ErasePlan::typicalMs(timing, 4096)},
+		{32768, 0x52, ErasePlan::typicalMs(timing, 32768)},
+		{65536, 0xD8, ErasePlan::typicalMs(timing, 65536)},
+	};
+	CHECK(types[0].typMs == 45);
+	CHECK(types[1].typMs == (45 + 150) / 2);
+	CHECK(types[2].typMs == 150);
+	CHECK(ErasePlan::typicalMs(timing, 262144) == 4 * 150);
+	
+	//Aligned 64 KiB blocks are one command each
+	ErasePlan::Plan whole = ErasePlan::plan(types, 0, 0x40000);
+	CHECK(tiles(whole));
+	CHECK(whole.exact(0, 0x40000));
+	CHECK(whole.steps.size() == 4 && count(whole, 65536) == 4);
+	CHECK(whole.typMs == 4 * 150);
+	
+	//Unaligned edges: sectors up to the 32 KiB boundary, then a 32 KiB
+	//block, 64 KiB blocks, and sectors after the last one
+	ErasePlan::Plan edges = ErasePlan::plan(types, 0x3000, 0x52000);
+	CHECK(tiles(edges));
+	CHECK(edges.exact(0x3000, 0x52000));
+	CHECK(count(edges, 4096) == 7 && count(edges, 32768) == 1 && count(edges, 65536) == 4);
+	CHECK(edges.typMs == 7 * 45 + 97 + 4 * 150);
+	
+	//Widened to the smallest erase, never past it
+	ErasePlan::Plan widened = ErasePlan::plan(types, 0x100, 0x1001);
+	CHECK(tiles(widened));
+	CHECK(widened.start == 0 && widened.end == 0x2000);
+	CHECK(!widened.exact(0x100, 0x1001));
+	CHECK(count(widened, 4096) == 2);
+	
+	//When sectors are cheaper than a block, the block is not used
+	const std::vector<ErasePlan::Type> slowBlocks = {{4096, 0x20, 10}, {65536, 0xD8, 500}};
+	ErasePlan::Plan sectors = ErasePlan::plan(slowBlocks, 0, 0x20000);
+	CHECK(tiles(sectors));
+	CHECK(count(sectors, 4096) == 32 && sectors.typMs == 320);
+	
+	//A zero typical time is costed as 1 ms, so the fewest commands win
+	const std::vector<ErasePlan::Type> untimed = {{4096, 0x20, 0}, {65536, 0xD8, 0}};
+	ErasePlan::Plan fewest = ErasePlan::plan(untimed, 0, 0x20000);
+	CHECK(fewest.steps.size() == 2);
+	
+	//Nothing to do
+	CHECK(ErasePlan::plan(types, 0x1000, 0x1000).steps.empty());
+	CHECK(ErasePlan::plan(types, 0x2000, 0x1000).steps.empty());
+	CHECK(ErasePlan::plan({}, 0, 0x1000).steps.empty());
+	
+	return Check::result("eraseplan");
+}
@@ -0,0 +1,80 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <sys/mman.h>
+
+#include "check.hpp"
+#include "gpiomem.hpp"
+#include "kernels.hpp"
+
+//GpioMem attached to an anonymous mapping standing in for /dev/gpiomem. The
+//register block is plain memory here, so each test looks at the words the
+//driver stored rather than at pin levels
+int main() {
+	void *block = mmap(nullptr, GpioReg::BLOCK_SIZE, PROT_READ | PROT_WRITE,
+	                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	CHECK(block != MAP_FAILED);
+	if(block == MAP_FAILED) return Check::result("gpiomem");
+	volatile uint32_t *regs = static_cast<volatile uint32_t *>(block);
+	
+	GpioMem mem;
+	CHECK(!mem.isOpen());
+	CHECK(!mem.open("/nonexistent/gpiomem"));
+	CHECK(!mem.isOpen());
+	mem.attach(regs);
+	CHECK(mem.isOpen());
+	
+	//set/clr store the mask as given, write() picks the register
+	mem.set(0x00800400u);
+	CHECK(regs[GpioReg::GPSET0] == 0x00800400u);
+	mem.clr(0x80000001u);
+	CHECK(regs[GpioReg::GPCLR0] == 0x80000001u);
+	mem.write(17, 1);
+	CHECK(regs[GpioReg::GPSET0] == (1u << 17));
+	mem.write(4, 0);
+	CHECK(regs[GpioReg::GPCLR0] == (1u << 4));
+	
+	//Levels come from GPLEV only
+	regs[GpioReg::GPLEV0] = 0x80000200u;
+	CHECK(mem.lev() == 0x80000200u);
+	CHECK(mem.read(9) == 1);
+	CHECK(mem.read(31) == 1);
+	CHECK(mem.read(10) == 0);
+	
+	//Function select: 3 bits per pin, 10 pins per word, neighbours kept
+	regs[GpioReg::GPFSEL0 + 1] = 0x3FFFFFFFu;
+	mem.setMode(17, GpioReg::FSEL_INPUT);
+	CHECK(regs[GpioReg::GPFSEL0 + 1] == (0x3FFFFFFFu & ~(7u << 21)));
+	mem.setMode(17, GpioReg::FSEL_OUTPUT);
+	CHECK(regs[GpioReg::GPFSEL0 + 1] == ((0x3FFFFFFFu & ~(7u << 21)) | (1u << 21)));
+	regs[GpioReg::GPFSEL0] = 0;
+	mem.setMode(0, GpioReg::FSEL_OUTPUT);
+	mem.setMode(9, GpioReg::FSEL_OUTPUT);
+	CHECK(regs[GpioReg::GPFSEL0] == ((1u << 0) | (1u << 27)));
+	
+	//A kernel through MemPort stores to the same registers, its last two
+	//stores raise and drop SCLK
+	const Kernel::Lanes lanes = {1u << 11, {1u << 10, 0, 0, 0}, {9, 0, 0, 0}};
+	Kernel::MemPort port = {mem};
+	const unsigned char byte = 0x01;
+	Kernel::BitKernel<Kernel::MemPort, Kernel::NoDelay, 1>::run(
+		port, Kernel::NoDelay(), lanes, &byte, nullptr, 1);
+	CHECK(regs[GpioReg::GPCLR0] == (1u << 11));
+	CHECK(regs[GpioReg::GPSET0] == (1u << 11));
+	
+	//Detaching leaves the caller's mapping alone
+	mem.close();
+	CHECK(!mem.isOpen());
+	regs[GpioReg::GPLEV0] = 0;
+	CHECK(munmap(block, GpioReg::BLOCK_SIZE) == 0);
+	
+	return Check::result("gpiomem");
+}
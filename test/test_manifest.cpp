@@ -0,0 +1,91 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "check.hpp"
+#include "filemanager.hpp"
+#include "manifest.hpp"
+#include "xxh64.hpp"
+
+//A temporary file holding text, removed by the caller
+static std::string tempFile(const std::string &text) {
+	char path[] = "/tmp/splasher_manifestXXXXXX";
+	const int fd = mkstemp(path);
+	if(fd < 0) return "";
+	CHECK(write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size()));
+	close(fd);
+	return path;
+}
+
+static std::string header(uint64_t offset, uint64_t bytes, uint32_t unit, size_t count) {
+	return "splasher-manifest 1\njedec ef4018\nuid -\noffset " + std::to_string(offset) +
+	       "\nbytes " + std::to_string(bytes) + "\nunit " + std::to_string(unit) +
+	       "\nhashes " + std::to_string(count) + "\n";
+}
+
+int main() {
+	//10000 bytes written at 0x1100 touch three 4 KiB units, the first and
+	//last only in part
+	std::string bytes;
+	for(unsigned int i = 0; i < 10000; i++) bytes.push_back(static_cast<char>(i * 7));
+	const std::string imagePath = tempFile(bytes);
+	CHECK(!imagePath.empty());
+	
+	Manifest image;
+	image.jedec = "ef4018";
+	{
+		BinFile file(imagePath.c_str(), 'r');
+		image.hashImage(file, 0x1100, 1 << 20, 4096);
+	}
+	CHECK(image.bytes == 10000);
+	CHECK(image.hashes.size() == 3);
+	CHECK(image.unitStart(0) == 0x1000 && image.unitStart(2) == 0x3000);
+	const unsigned char *data = reinterpret_cast<const unsigned char *>(bytes.data());
+	CHECK(image.hashes[0] == xxh64(data, 0x2000 - 0x1100));
+	CHECK(image.hashes[1] == xxh64(data + 0xF00, 4096));
+	
+	//Saved and loaded back unchanged
+	const std::string savedPath = tempFile("");
+	CHECK(image.save(savedPath));
+	Manifest loaded;
+	CHECK(loaded.load(savedPath));
+	CHECK(loaded.jedec == image.jedec && loaded.uid.empty());
+	CHECK(loaded.offset == 0x1100 && loaded.bytes == 10000 && loaded.unit == 4096);
+	CHECK(loaded.hashes == image.hashes);
+	
+	//The hash count must match the units the range touches
+	const std::string hashes = "1\n2\n3\n";
+	std::vector<std::string> files = {
+		tempFile(header(0x1100, 10000, 4096, 3) + hashes),
+		tempFile(header(0x1100, 10000, 4096, 1000000000) + hashes),
+		tempFile(header(0x1100, 10000, 4096, 2) + hashes),
+		tempFile(header(0x1100, 10000, 4096, 3) + "1\n2\n"),
+		tempFile(header(0x1100, 10000, 0, 3) + hashes),
+		tempFile(header(4095, UINT64_MAX - 10, 4096, 3) + hashes),
+		tempFile("not-a-manifest 1\n"),
+	};
+	Manifest check;
+	CHECK(check.load(files[0]));
+	CHECK(check.hashes == std::vector<uint64_t>({1, 2, 3}));
+	for(size_t i = 1; i < files.size(); i++) CHECK(!check.load(files[i]));
+	CHECK(!check.load("/nonexistent/manifest"));
+	
+	for(const std::string &path : files) remove(path.c_str());
+	remove(savedPath.c_str());
+	remove(imagePath.c_str());
+	return Check::result("manifest");
+}
@@ -0,0 +1,181 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <sys/mman.h>
+#include <cstring>
+#include <vector>
+
+#include "check.hpp"
+#include "gather.hpp"
+#include "gpiomem.hpp"
+#include "kernels.hpp"
+
+static const uint32_t SCLK = 1u << 11;
+
+/*** Simulated chips **********************************************************/
+//Chips sharing SCLK, each with its own MISO pin, behind a fake register
+//block. Stores go through GpioMem as in hwSPI, and on every SCLK falling
+//edge each chip puts its next bit into GPLEV. Pins that are not MISO
+//toggle on every edge, as unrelated GPIO activity would
+struct Chip {
+	unsigned int pin;
+	std::vector<unsigned char> data;
+};
+
+struct ChipBus {
+	GpioMem &mem;
+	volatile uint32_t *regs;
+	std::vector<Chip> &chips;
+	size_t bit = 0;
+	bool high = false;
+	
+	void present() {
+		uint32_t level = regs[GpioReg::GPLEV0] & SCLK;
+		level |= (bit & 1) ? 0x0000F0F0u : 0x0F0F0000u;
+		for(const Chip &chip : chips) {
+			level &= ~(1u << chip.pin);
+			if(bit / 8 < chip.data.size() &&
+			   ((chip.data[bit / 8] >> (7 - bit % 8)) & 1)) {
+				level |= 1u << chip.pin;
+			}
+		}
+		regs[GpioReg::GPLEV0] = level;
+	}
+	
+	void set(uint32_t mask) {
+		mem.set(mask);
+		if(mask & SCLK) {
+			high = true;
+			regs[GpioReg::GPLEV0] |= SCLK;
+		}
+	}
+	void clr(uint32_t mask) {
+		mem.clr(mask);
+		if((mask & SCLK) && high) {
+			high = false;
+			regs[GpioReg::GPLEV0] &= ~SCLK;
+			++bit;
+			present();
+		}
+	}
+	void write(uint32_t setMask, uint32_t clrMask) {
+		set(setMask);
+		clr(clrMask);
+	}
+	uint32_t lev() { return mem.lev(); }
+};
+
+//What hwSPI::readMulti does per block: capture GPLEV snapshots through the
+//single lane kernel with MOSI undriven, then split them per MISO pin
+static void readMulti(ChipBus &bus, const std::vector<unsigned int> &pins,
+                      std::vector<std::vector<unsigned char>> &outs, size_t n,
+                      size_t blockBytes) {
+	const Kernel::Lanes lanes = {SCLK, {0, 0, 0, 0}, {0, 0, 0, 0}};
+	std::vector<uint32_t> levels(blockBytes * 8);
+	std::vector<unsigned char *> dst;
+	for(std::vector<unsigned char> &out : outs) {
+		out.assign(n, 0);
+		dst.push_back(out.data());
+	}
+	
+	while(n > 0) {
+		size_t block = (n > blockBytes) ? blockBytes : n;
+		Kernel::BitKernel<ChipBus, Kernel::NoDelay, 1>::capture(
+			bus, Kernel::NoDelay(), lanes, levels.data(), block);
+		Gather::packBitsMulti(levels.data(), block * 8, pins.data(), pins.size(),
+		                      dst.data());
+		for(unsigned char *&p : dst) p += block;
+		n -= block;
+	}
+}
+
+static uint32_t rng = 0x12345678u;
+static unsigned char nextByte() {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return static_cast<unsigned char>(rng >> 24);
+}
+
+int main() {
+	void *block = mmap(nullptr, GpioReg::BLOCK_SIZE, PROT_READ | PROT_WRITE,
+	                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	CHECK(block != MAP_FAILED);
+	if(block == MAP_FAILED) return Check::result("multichip");
+	volatile uint32_t *regs = static_cast<volatile uint32_t *>(block);
+	GpioMem mem;
+	mem.attach(regs);
+	
+	//Chips at both ends of bank 0 and next to SCLK, one all zero, one all
+	//ones, the rest random. 1000 bytes is not a whole number of blocks
+	const size_t bytes = 1000;
+	std::vector<Chip> chips = {
+		{0, {}}, {9, {}}, {10, {}}, {12, {}}, {25, {}}, {31, {}}
+	};
+	for(size_t i = 0; i < chips.size(); i++) {
+		for(size_t b = 0; b < bytes; b++) {
+			unsigned char v = nextByte();
+			if(i == 1) v = 0x00;
+			if(i == 4) v = 0xFF;
+			chips[i].data.push_back(v);
+		}
+	}
+	
+	std::vector<unsigned int> pins;
+	for(const Chip &chip : chips) pins.push_back(chip.pin);
+	
+	for(size_t blockBytes : {size_t(1), size_t(7), size_t(64), size_t(256)}) {
+		regs[GpioReg::GPLEV0] = 0;
+		ChipBus bus = {mem, regs, chips};
+		bus.present();
+		
+		std::vector<std::vector<unsigned char>> outs(chips.size());
+		readMulti(bus, pins, outs, bytes, blockBytes);
+		for(size_t i = 0; i < chips.size(); i++) CHECK(outs[i] == chips[i].data);
+		CHECK(bus.bit == bytes * 8);
+		CHECK(!bus.high);
+	}
+	
+	//A chip that stops answering reads as 0 from there on, the others are
+	//unaffected
+	chips[2].data.resize(bytes / 2);
+	{
+		regs[GpioReg::GPLEV0] = 0;
+		ChipBus bus = {mem, regs, chips};
+		bus.present();
+		std::vector<std::vector<unsigned char>> outs(chips.size());
+		readMulti(bus, pins, outs, bytes, 256);
+		std::vector<unsigned char> expect = chips[2].data;
+		expect.resize(bytes, 0);
+		CHECK(outs[2] == expect);
+		CHECK(outs[3] == chips[3].data);
+	}
+	
+	//The vector gather agrees with the scalar one on the same snapshots
+	{
+		std::vector<uint32_t> levels(8 * 333 + 5);
+		for(uint32_t &l : levels) {
+			l = (uint32_t(nextByte()) << 24) | (uint32_t(nextByte()) << 16) |
+			    (uint32_t(nextByte()) << 8) | nextByte();
+		}
+		for(unsigned int pin = 0; pin < 32; pin++) {
+			std::vector<unsigned char> fast(334, 0xAA), slow(334, 0xAA);
+			Gather::packBits(levels.data(), levels.size(), pin, fast.data());
+			Gather::packBitsScalar(levels.data(), levels.size(), pin, slow.data());
+			CHECK(fast == slow);
+			CHECK(fast[333] == 0xAA);
+		}
+	}
+	
+	mem.close();
+	munmap(block, GpioReg::BLOCK_SIZE);
+	return Check::result("multichip");
+}
@@ -0,0 +1,54 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "check.hpp"
+#include "patch.hpp"
+
+int main() {
+	char path[] = "/tmp/splasher_patchXXXXXX";
+	const int fd = mkstemp(path);
+	CHECK(fd >= 0);
+	if(fd < 0) return Check::result("patch");
+	unsigned char env[300];
+	for(unsigned int i = 0; i < sizeof(env); i++) env[i] = static_cast<unsigned char>(i);
+	CHECK(write(fd, env, sizeof(env)) == static_cast<ssize_t>(sizeof(env)));
+	close(fd);
+	
+	std::vector<Patch::Update> updates;
+	CHECK(Patch::parse("0x3FF000=00:16:3e:5a:1b:2c,0x3F800,4K=AB,8K", path, updates));
+	CHECK(updates.size() == 4);
+	CHECK(updates[0].addr == 0x3FF000);
+	CHECK(updates[0].data == std::vector<unsigned char>({0x00, 0x16, 0x3E, 0x5A, 0x1B, 0x2C}));
+	CHECK(updates[0].end() == 0x3FF006);
+	CHECK(updates[1].addr == 0x3F800 && updates[1].data.size() == sizeof(env));
+	CHECK(updates[1].data[299] == env[299]);
+	CHECK(updates[2].addr == 4096 && updates[2].data == std::vector<unsigned char>({0xAB}));
+	CHECK(updates[3].data == updates[1].data);
+	
+	//':' is only a separator, pairs may be written without it
+	CHECK(Patch::parse("0=dead:beef", path, updates));
+	CHECK(updates[0].data == std::vector<unsigned char>({0xDE, 0xAD, 0xBE, 0xEF}));
+	
+	CHECK(!Patch::parse("0x10=abc", path, updates));
+	CHECK(!Patch::parse("0x10=zz", path, updates));
+	CHECK(!Patch::parse("0x10=", path, updates));
+	CHECK(!Patch::parse("0x10=::", path, updates));
+	CHECK(!Patch::parse("nope=00", path, updates));
+	CHECK(!Patch::parse("0x10=00,", path, updates));
+	CHECK(!Patch::parse("0x10", "/dev/null", updates));
+	
+	remove(path);
+	return Check::result("patch");
+}
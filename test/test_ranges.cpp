@@ -0,0 +1,63 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include "check.hpp"
+#include "ranges.hpp"
+
+int main() {
+	uint64_t value = 0;
+	CHECK(Ranges::parseSize("4096", value) && value == 4096);
+	CHECK(Ranges::parseSize("0x3F0000", value) && value == 0x3F0000);
+	CHECK(Ranges::parseSize("64K", value) && value == 65536);
+	CHECK(Ranges::parseSize("0x10M", value) && value == 0x10 * 1048576ull);
+	CHECK(Ranges::parseSize("4096M", value) && value == 0x100000000ull);
+	CHECK(!Ranges::parseSize("4097M", value));
+	CHECK(!Ranges::parseSize("", value));
+	CHECK(!Ranges::parseSize("0x", value));
+	CHECK(!Ranges::parseSize("12G", value));
+	CHECK(!Ranges::parseSize("-1", value));
+	
+	std::vector<Ranges::Range> ranges;
+	CHECK(Ranges::parse("0+64K,0x3F0000-4M", ranges));
+	CHECK(ranges.size() == 2);
+	CHECK(ranges[0].start == 0 && ranges[0].bytes == 65536);
+	CHECK(ranges[1].start == 0x3F0000 && ranges[1].end() == 0x400000);
+	
+	CHECK(!Ranges::parse("", ranges));
+	CHECK(!Ranges::parse("0x1000", ranges));
+	CHECK(!Ranges::parse("0+0", ranges));
+	CHECK(!Ranges::parse("0x2000-0x1000", ranges));
+	CHECK(!Ranges::parse("0+4K,", ranges));
+	
+	//Out of order, overlapping, touching, within the gap and past it
+	CHECK(Ranges::parse("0x9000+0x100,0x0+0x1000,0x800+0x1000,0x1800+0x10,"
+	                    "0x2800+0x10,0x5000+0x100", ranges));
+	std::vector<Ranges::Read> reads = Ranges::coalesce(ranges, 0x1000);
+	CHECK(ranges[0].start == 0x0 && ranges[5].start == 0x9000);
+	CHECK(reads.size() == 3);
+	CHECK(reads[0].start == 0 && reads[0].end() == 0x2810);
+	CHECK(reads[0].parts.size() == 4);
+	CHECK(reads[1].start == 0x5000 && reads[1].bytes == 0x100);
+	CHECK(reads[2].start == 0x9000 && reads[2].parts.size() == 1 && reads[2].parts[0] == 5);
+	
+	//No gap: only overlapping or touching ranges share a read
+	CHECK(Ranges::parse("0+0x100,0x100+0x100,0x201+0x10", ranges));
+	reads = Ranges::coalesce(ranges, 0);
+	CHECK(reads.size() == 2);
+	CHECK(reads[0].bytes == 0x200);
+	
+	//A range inside another does not shorten the read
+	CHECK(Ranges::parse("0+0x1000,0x100+0x10", ranges));
+	reads = Ranges::coalesce(ranges, 0);
+	CHECK(reads.size() == 1 && reads[0].bytes == 0x1000);
+	
+	return Check::result("ranges");
+}
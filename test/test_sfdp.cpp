@@ -0,0 +1,116 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstring>
+#include <string>
+
+#include "check.hpp"
+#include "sfdp.hpp"
+
+//SFDP header, parameter header and Basic Flash Parameter Table as read from
+//a W25Q128JV
+static const unsigned char HEADER[8] = {'S', 'F', 'D', 'P', 0x06, 0x01, 0x00, 0xFF};
+static const unsigned char PARAM[8] = {0x00, 0x06, 0x01, 0x10, 0x80, 0x00, 0x00, 0xFF};
+static const unsigned char BFPT[64] = {
+	0xE5, 0x20, 0xF9, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x44, 0xEB, 0x08, 0x6B,
+	0x08, 0x3B, 0x42, 0xBB, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00,
+	0xFF, 0xFF, 0x40, 0xEB, 0x0C, 0x20, 0x0F, 0x52, 0x10, 0xD8, 0x00, 0x00,
+	0x36, 0x02, 0xA6, 0x00, 0x82, 0xEA, 0x14, 0xC4, 0xE9, 0x63, 0x76, 0x33,
+	0x7A, 0x75, 0x7A, 0x75, 0xF7, 0xA2, 0xD5, 0x5C, 0x19, 0xF7, 0x4D, 0xFF,
+	0xE9, 0x30, 0xF8, 0x80
+};
+
+int main() {
+	FlashCaps caps;
+	CHECK(Sfdp::parseHeader(HEADER, caps) == 1);
+	CHECK(caps.revMajor == 1 && caps.revMinor == 6);
+	CHECK(!caps.valid);
+	
+	unsigned char bad[8];
+	memcpy(bad, HEADER, 8);
+	bad[0] = 'X';
+	FlashCaps ignored;
+	CHECK(Sfdp::parseHeader(bad, ignored) == 0);
+	memcpy(bad, HEADER, 8);
+	bad[5] = 2;
+	CHECK(Sfdp::parseHeader(bad, ignored) == 0);
+	
+	Sfdp::Table table = Sfdp::parseTable(PARAM);
+	CHECK(table.id == Sfdp::BFPT_ID);
+	CHECK(table.revMajor == 1 && table.revMinor == 6);
+	CHECK(table.dwords == 16);
+	CHECK(table.pointer == 0x80);
+	
+	CHECK(!Sfdp::parseBfpt(BFPT, 8, caps));
+	CHECK(!caps.valid);
+	CHECK(Sfdp::parseBfpt(BFPT, table.dwords, caps));
+	CHECK(caps.valid);
+	CHECK(caps.bytes == 16 * 1048576);
+	CHECK(caps.pageSize == 256);
+	CHECK(caps.addr3 && !caps.addr4);
+	CHECK(caps.qe == FlashCaps::QE::SR2_BIT1);
+	
+	//1-4-4 and 1-2-2 have mode clocks, the output reads do not
+	CHECK(caps.read144.supported && caps.read144.cmd == 0xEB);
+	CHECK(caps.read144.addrLanes == 4 && caps.read144.dataLanes == 4);
+	CHECK(caps.read144.modeClocks == 2 && caps.read144.dummyClocks == 4);
+	CHECK(caps.read114.supported && caps.read114.cmd == 0x6B);
+	CHECK(caps.read114.modeClocks == 0 && caps.read114.dummyClocks == 8);
+	CHECK(caps.read122.supported && caps.read122.cmd == 0xBB);
+	CHECK(caps.read122.addrLanes == 2 && caps.read122.modeClocks == 2);
+	CHECK(caps.read112.supported && caps.read112.cmd == 0x3B);
+	CHECK(caps.findRead(0xEB) == &caps.read144);
+	CHECK(caps.findRead(0x0B) == nullptr);
+	
+	CHECK(caps.erase[0].bytes == 4096 && caps.erase[0].cmd == 0x20);
+	CHECK(caps.erase[1].bytes == 32768 && caps.erase[1].cmd == 0x52);
+	CHECK(caps.erase[2].bytes == 65536 && caps.erase[2].cmd == 0xD8);
+	CHECK(caps.erase[3].bytes == 0);
+	CHECK(caps.smallestErase() == &caps.erase[0]);
+	
+	CHECK(caps.describe() == "SFDP 1.6, 16MiB, page 256, erase 4KiB 32KiB 64KiB, "
+	                         "reads 1-1-1 1-1-2 1-2-2 1-1-4 1-4-4");
+	
+	//Density as a power of two, and a part with only 4-byte addresses and
+	//no fast reads
+	unsigned char big[64];
+	memcpy(big, BFPT, sizeof(big));
+	big[2] = 0x04;                                   // DWORD 1: 4-byte only
+	big[4] = 33; big[5] = 0; big[6] = 0; big[7] = 0x80;  // 2^33 bits
+	FlashCaps large;
+	CHECK(Sfdp::parseBfpt(big, 16, large));
+	CHECK(large.bytes == 1024ull * 1048576);
+	CHECK(!large.addr3 && large.addr4);
+	CHECK(!large.read112.supported && !large.read144.supported);
+	CHECK(large.findRead(0xEB) == nullptr);
+	
+	//Quad Enable requirements, DWORD 15 bits 22:20
+	const FlashCaps::QE qer[8] = {
+		FlashCaps::QE::NONE, FlashCaps::QE::SR2_BIT1_NO_READ, FlashCaps::QE::SR1_BIT6,
+		FlashCaps::QE::SR2_BIT7, FlashCaps::QE::SR2_BIT1, FlashCaps::QE::SR2_BIT1,
+		FlashCaps::QE::SR2_BIT1_WRSR2, FlashCaps::QE::UNKNOWN
+	};
+	for(unsigned int value = 0; value < 8; value++) {
+		unsigned char table[64];
+		memcpy(table, BFPT, sizeof(table));
+		table[58] = static_cast<unsigned char>((table[58] & 0x8F) | (value << 4));
+		FlashCaps qe;
+		CHECK(Sfdp::parseBfpt(table, 16, qe));
+		CHECK(qe.qe == qer[value]);
+	}
+	
+	//Tables before JESD216A stop short of DWORD 15
+	FlashCaps early;
+	CHECK(Sfdp::parseBfpt(BFPT, 9, early));
+	CHECK(early.qe == FlashCaps::QE::UNKNOWN);
+	
+	return Check::result("sfdp");
+}
@@ -0,0 +1,189 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <linux/spi/spidev.h>
+
+#include "check.hpp"
+#include "hardware.hpp"
+
+/*** Simulated spidev driver and chip *****************************************/
+//Stands in for ioctl(). Each SPI_IOC_MESSAGE(1) is recorded, and the bytes
+//sent since CE was asserted are played to a chip that answers JEDEC ID and
+//Fast Read (0x0B, 3 address bytes, 8 dummy clocks) with data[addr] = addr.
+//CE drops after a message without cs_change, as the driver does
+struct Message {
+	size_t len;
+	bool csChange;
+};
+
+static std::vector<Message> messages;
+static std::vector<unsigned long> configs;
+static std::vector<unsigned char> cycle;
+static bool csLow = false;
+static unsigned int csCycles = 0;
+static unsigned long failRequest = 0;
+
+static unsigned char chipByte(size_t pos) {
+	if(cycle.empty()) return 0xFF;
+	if(cycle[0] == 0x9F) {
+		static const unsigned char id[3] = {0x01, 0x02, 0x19};
+		return (pos >= 1 && pos <= 3) ? id[pos - 1] : 0xFF;
+	}
+	if(cycle[0] == 0x0B && pos >= 5 && cycle.size() >= 4) {
+		const uint32_t addr = (uint32_t(cycle[1]) << 16) | (cycle[2] << 8) | cycle[3];
+		return static_cast<unsigned char>(addr + (pos - 5));
+	}
+	return 0xFF;
+}
+
+static int fakeIoctl(int fd, unsigned long request, void *arg) {
+	(void)fd;
+	if(request == failRequest) {
+		errno = EIO;
+		return -1;
+	}
+	if(request != SPI_IOC_MESSAGE(1)) {
+		configs.push_back(request);
+		return 0;
+	}
+	
+	const spi_ioc_transfer *xfer = static_cast<const spi_ioc_transfer *>(arg);
+	messages.push_back({xfer->len, xfer->cs_change != 0});
+	
+	if(xfer->len != 0 && !csLow) {
+		csLow = true;
+		++csCycles;
+		cycle.clear();
+	}
+	const unsigned char *tx = reinterpret_cast<const unsigned char *>(xfer->tx_buf);
+	unsigned char *rx = reinterpret_cast<unsigned char *>(xfer->rx_buf);
+	for(size_t i = 0; i < xfer->len; i++) {
+		const size_t pos = cycle.size();
+		if(rx != nullptr) rx[i] = chipByte(pos);
+		cycle.push_back(tx != nullptr ? tx[i] : 0);
+	}
+	if(!xfer->cs_change) csLow = false;
+	return 0;
+}
+
+static void reset() {
+	messages.clear();
+	configs.clear();
+	cycle.clear();
+	csLow = false;
+	csCycles = 0;
+	failRequest = 0;
+}
+
+/*** Tests ********************************************************************/
+static void testOpen() {
+	reset();
+	hwSpidev spi("/dev/null", 1000000, fakeIoctl);
+	CHECK(spi.isOpen());
+	CHECK(configs.size() == 3);
+	CHECK(spi.clockKHz() == 1000);
+	
+	CHECK(spi.setSpeed(2000000));
+	CHECK(spi.clockKHz() == 2000);
+	
+	//A driver that refuses the mode leaves the interface closed
+	reset();
+	failRequest = SPI_IOC_WR_MODE;
+	hwSpidev refused("/dev/null", 1000000, fakeIoctl);
+	CHECK(!refused.isOpen());
+	CHECK(!refused.setSpeed(1000000));
+}
+
+static void testReadId() {
+	reset();
+	hwSpidev spi("/dev/null", 1000000, fakeIoctl);
+	ChipId id{};
+	CHECK(spi.readId(id));
+	CHECK(id.manufacturer == 0x01 && id.memoryType == 0x02 && id.capacity == 0x19);
+	CHECK(csCycles == 1);
+	CHECK(!csLow);
+}
+
+//A read longer than bufsiz goes out as bufsiz messages, all holding CE, and
+//only the empty message from stop() releases it
+static void testLargeRead() {
+	reset();
+	hwSpidev spi("/dev/null", 1000000, fakeIoctl);
+	const size_t chunk = spi.preferredChunk();
+	const size_t n = 3 * chunk + 17;
+	
+	ReadOp op;
+	op.cmd = Cmd::S25::FAST_READ;
+	op.dummyCycles = 8;
+	std::vector<unsigned char> buf(n);
+	const uint32_t addr = 0x012340;
+	
+	messages.clear();
+	spi.start();
+	CHECK(spi.beginRead(op, addr));
+	spi.read(buf.data(), n);
+	CHECK(csLow);
+	spi.stop();
+	
+	CHECK(!spi.failed());
+	CHECK(csCycles == 1);
+	CHECK(!csLow);
+	
+	bool dataOk = true;
+	for(size_t i = 0; i < n; i++) {
+		if(buf[i] != static_cast<unsigned char>(addr + i)) dataOk = false;
+	}
+	CHECK(dataOk);
+	
+	//Header messages, then the data split at bufsiz, then stop()
+	size_t dataMessages = 0, longest = 0, total = 0;
+	for(size_t i = 0; i + 1 < messages.size(); i++) {
+		CHECK(messages[i].csChange);
+		if(messages[i].len > longest) longest = messages[i].len;
+		total += messages[i].len;
+		if(messages[i].len == chunk) ++dataMessages;
+	}
+	CHECK(longest <= chunk);
+	CHECK(dataMessages == 3);
+	CHECK(total == 5 + n);
+	CHECK(messages.back().len == 0);
+	CHECK(!messages.back().csChange);
+}
+
+//A failed message marks the interface failed for good
+static void testFailure() {
+	reset();
+	hwSpidev spi("/dev/null", 1000000, fakeIoctl);
+	failRequest = SPI_IOC_MESSAGE(1);
+	unsigned char buf[4];
+	spi.start();
+	spi.read(buf, sizeof(buf));
+	spi.stop();
+	CHECK(spi.failed());
+	
+	failRequest = 0;
+	spi.start();
+	spi.read(buf, sizeof(buf));
+	spi.stop();
+	CHECK(spi.failed());
+}
+
+int main() {
+	testOpen();
+	testReadId();
+	testLargeRead();
+	testFailure();
+	return Check::result("spidev");
+}
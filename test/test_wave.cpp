@@ -0,0 +1,140 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <algorithm>
+#include <vector>
+
+#include "check.hpp"
+#include "wave.hpp"
+
+static const uint32_t SCLK = 1u << 11;
+static const uint32_t MOSI = 1u << 10;
+static const uint32_t MISO = 1u << 9;
+
+/*** Simulated chip ***********************************************************/
+//Plays a waveform back one microsecond at a time, as the DMA sampler would
+//see it. The chip latches MOSI on each rising edge and moves MISO on to its
+//next bit after each falling edge. noise flips MISO while SCLK is low, which
+//the decoder must ignore
+struct Replay {
+	std::vector<Wave::Sample> samples;
+	std::vector<unsigned char> mosiBytes;
+	uint32_t totalUs = 0;
+	
+	Replay(const std::vector<Wave::Pulse> &pulses,
+	       const std::vector<unsigned char> &response, bool noise) {
+		uint32_t level = 0;
+		size_t bit = 0;
+		unsigned char acc = 0;
+		for(const Wave::Pulse &p : pulses) {
+			const uint32_t prev = level;
+			level = (level | p.on) & ~p.off;
+			if(!(prev & SCLK) && (level & SCLK)) {
+				acc = static_cast<unsigned char>((acc << 1) | ((level & MOSI) ? 1 : 0));
+				if((bit % 8) == 7) mosiBytes.push_back(acc);
+			}
+			if((prev & SCLK) && !(level & SCLK)) ++bit;
+			
+			bool out = false;
+			if(bit / 8 < response.size()) out = (response[bit / 8] >> (7 - bit % 8)) & 1;
+			level = out ? (level | MISO) : (level & ~MISO);
+			
+			for(uint32_t us = 0; us < p.us; us++) {
+				uint32_t seen = level;
+				if(noise && !(level & SCLK) && (us & 1)) seen ^= MISO;
+				samples.push_back({totalUs++, seen});
+			}
+		}
+	}
+};
+
+static bool decode(const Replay &replay, size_t bytes, size_t chunk,
+                   std::vector<unsigned char> &out) {
+	out.assign(bytes, 0);
+	Wave::MisoDecoder decoder;
+	decoder.reset(SCLK, MISO, bytes * 8, out.data());
+	bool done = false;
+	for(size_t i = 0; i < replay.samples.size(); i += chunk) {
+		size_t count = std::min(chunk, replay.samples.size() - i);
+		done = decoder.feed(replay.samples.data() + i, count);
+	}
+	CHECK(decoder.decodedBits() == bytes * 8);
+	return done;
+}
+
+int main() {
+	const std::vector<unsigned char> tx = {0x9F, 0x00, 0xA5, 0xFF, 0x3C};
+	const std::vector<unsigned char> response = {0xEF, 0x40, 0x18, 0x81, 0x7E};
+	const unsigned int halfUs = 2;
+	
+	//16 half periods per byte and a closing SCLK low
+	std::vector<Wave::Pulse> pulses;
+	Wave::buildPulses(tx.data(), tx.size(), MOSI, SCLK, halfUs, pulses);
+	CHECK(pulses.size() == tx.size() * 16 + 1);
+	uint32_t totalUs = 0;
+	for(const Wave::Pulse &p : pulses) {
+		CHECK(p.us == halfUs);
+		CHECK(((p.on | p.off) & ~(SCLK | MOSI)) == 0);
+		totalUs += p.us;
+	}
+	CHECK(totalUs == (tx.size() * 16 + 1) * halfUs);
+	CHECK(pulses.back().off == SCLK);
+	
+	//What the chip receives, and what comes back at any feed size
+	Replay replay(pulses, response, false);
+	CHECK(replay.mosiBytes == tx);
+	for(size_t chunk : {size_t(1), size_t(3), size_t(7), size_t(64), size_t(4096)}) {
+		std::vector<unsigned char> rx;
+		CHECK(decode(replay, response.size(), chunk, rx));
+		CHECK(rx == response);
+	}
+	
+	//MISO is only taken at the end of the high phase
+	Replay noisy(pulses, response, true);
+	std::vector<unsigned char> rx;
+	CHECK(decode(noisy, response.size(), 5, rx));
+	CHECK(rx == response);
+	
+	//Asking for fewer bits stops there and leaves the rest of rx alone
+	{
+		std::vector<unsigned char> part(3, 0x55);
+		Wave::MisoDecoder decoder;
+		decoder.reset(SCLK, MISO, 16, part.data());
+		CHECK(decoder.feed(replay.samples.data(), replay.samples.size()));
+		CHECK(decoder.decodedBits() == 16);
+		CHECK(part[0] == response[0] && part[1] == response[1] && part[2] == 0x55);
+	}
+	
+	//Samples that end early leave the decoder waiting
+	{
+		std::vector<unsigned char> part(response.size(), 0);
+		Wave::MisoDecoder decoder;
+		decoder.reset(SCLK, MISO, response.size() * 8, part.data());
+		CHECK(!decoder.feed(replay.samples.data(), replay.samples.size() / 2));
+		CHECK(!decoder.done());
+	}
+	
+	//Receive only: MOSI is never driven. Appends to what is there already
+	std::vector<Wave::Pulse> rxPulses(1, Wave::Pulse{0, 0, 7});
+	Wave::buildPulses(nullptr, 2, MOSI, SCLK, 1, rxPulses);
+	CHECK(rxPulses.size() == 1 + 2 * 16 + 1);
+	CHECK(rxPulses[0].us == 7);
+	for(size_t i = 1; i < rxPulses.size(); i++) {
+		CHECK(((rxPulses[i].on | rxPulses[i].off) & MOSI) == 0);
+	}
+	
+	//Nothing to send, nothing built
+	std::vector<Wave::Pulse> none;
+	Wave::buildPulses(tx.data(), 0, MOSI, SCLK, halfUs, none);
+	CHECK(none.empty());
+	
+	return Check::result("wave");
+}
@@ -0,0 +1,51 @@
+/*******************************************************************************
+* This file is part of splasher, see the public GitHub for more information:
+* https://github.com/ADBeta/splasher
+*
+* Splasher is a Raspberry Pi Program to flash, dump, clone and empty a large
+* selection of NAND or NOR Flash chips, including the 24 & 25 Series.
+* With the ability to support many protocols, including SPI, DSPI, QSPI, I2C,
+* and custom non-standard protocols certain manufacturers use.
+*
+* (c) ADBeta
+*******************************************************************************/
+#include <cstring>
+#include <vector>
+
+#include "check.hpp"
+#include "xxh64.hpp"
+
+static uint64_t hash(const char *text, uint64_t seed = 0) {
+	return xxh64(reinterpret_cast<const unsigned char *>(text), strlen(text), seed);
+}
+
+int main() {
+	//Reference values, as printed by xxhsum -H64
+	CHECK(hash("") == 0xEF46DB3751D8E999ull);
+	CHECK(hash("a") == 0xD24EC4F1A98C6E5Bull);
+	CHECK(hash("abc") == 0x44BC2CF5AD770999ull);
+	CHECK(hash("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ull);
+	CHECK(hash("0123456789012345678901234567890123456789") == 0xCA6FC80CBDE1A931ull);
+	CHECK(hash("abc", 1) != hash("abc"));
+	
+	//Every length through the 32 byte stripes and their tails, from an
+	//unaligned start, hashes the same as an aligned copy
+	std::vector<unsigned char> data(200);
+	for(size_t i = 0; i < data.size(); i++) data[i] = static_cast<unsigned char>(i * 7 + 3);
+	std::vector<unsigned char> shifted(data.size() + 1);
+	memcpy(shifted.data() + 1, data.data(), data.size());
+	uint64_t previous = 0;
+	for(size_t n = 0; n <= 100; n++) {
+		const uint64_t h = xxh64(data.data(), n);
+		CHECK(h == xxh64(shifted.data() + 1, n));
+		CHECK(h != previous);
+		previous = h;
+	}
+	
+	//One changed byte changes the hash
+	const uint64_t before = xxh64(data.data(), data.size());
+	data[150] ^= 0x01;
+	CHECK(xxh64(data.data(), data.size()) != before);
+	
+	return Check::result("xxh64");
+}